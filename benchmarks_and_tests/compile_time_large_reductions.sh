@@ -0,0 +1,126 @@
+#!/bin/bash
+
+# Compile-time guard for the BiRiscV pattern pass on large add trees.
+# Generates fully unrolled byte abs-diff and MAC reductions of growing size,
+# turns each into canonical IR once, times only the pattern pass on it
+# (opt -time-passes, best of RUNS) and fails if the time grows much faster
+# than the number of terms (the pass must stay linear in the size of the add
+# tree).
+
+set -e
+
+CLANG=../build/bin/clang
+OPT=../build/bin/opt
+CFLAGS="-O3 -march=rv32im_xbiriscv0p1 -mabi=ilp32 -target riscv32-unknown-elf"
+# What the optimization pipeline has done to the trees by the time the pass
+# runs: promote the locals, inline absdiff_u8, canonicalize to abs/zext
+PREPASSES="always-inline,function(sroa,early-cse,instcombine,simplifycfg)"
+SIZES="256 1024 4096"
+RUNS=3
+# Time may grow at most this many times faster than the term count between
+# two consecutive sizes (quadratic behaviour shows up as ~4x)
+MAX_GROWTH=2
+WORK_DIR=compile_time_reductions
+
+echo "=========================================================================="
+echo "BiRISCV Pattern Pass Compile-Time Benchmark"
+echo "=========================================================================="
+echo "Reduction sizes: $SIZES terms"
+echo ""
+
+# Check if clang and opt exist
+for TOOL in $CLANG $OPT; do
+    if [ ! -f "$TOOL" ]; then
+        echo "ERROR: $(basename $TOOL) not found at $TOOL"
+        echo "Please build LLVM first"
+        exit 1
+    fi
+done
+
+mkdir -p $WORK_DIR
+
+# Emit one straight-line SAD reduction over N bytes and one 5x5-style
+# convolution sum of N taps, both written out term by term
+generate_reduction() {
+    local n=$1
+    local file=$2
+
+    {
+        echo "#include <stdint.h>"
+        echo ""
+        echo "static inline uint32_t absdiff_u8(uint8_t a, uint8_t b) {"
+        echo "    return a > b ? a - b : b - a;"
+        echo "}"
+        echo ""
+        echo "uint32_t sad_unrolled_$n(const uint8_t *a, const uint8_t *b) {"
+        echo "    uint32_t acc = 0;"
+        for ((i = 0; i < n; i++)); do
+            echo "    acc += absdiff_u8(a[$i], b[$i]);"
+        done
+        echo "    return acc;"
+        echo "}"
+        echo ""
+        echo "int32_t conv_unrolled_$n(const int16_t *x, const int16_t *k) {"
+        echo "    int32_t acc = 0;"
+        for ((i = 0; i < n; i++)); do
+            echo "    acc += x[$i] * k[$i];"
+        done
+        echo "    return acc;"
+        echo "}"
+    } > $file
+}
+
+# Wall time of the pattern pass on one IR file in microseconds, from the
+# last "seconds (percent)" column of its -time-passes line
+time_pattern_pass() {
+    $OPT -passes=riscv-biriscv-patterns -time-passes -disable-output $1 2>&1 |
+        grep "RISCVBiRiscVPatternsPass" |
+        grep -oE '[0-9]+\.[0-9]+ +\( *[0-9.]+%\)' | tail -1 |
+        awk '{ printf "%d\n", $1 * 1000000 }'
+}
+
+PREV_N=""
+PREV_US=""
+STATUS=0
+
+for N in $SIZES; do
+    SRC=$WORK_DIR/reduction_$N.c
+    IR=$WORK_DIR/reduction_$N.ll
+    generate_reduction $N $SRC
+    $CLANG $CFLAGS -Xclang -disable-llvm-optzns -S -emit-llvm $SRC -o - |
+        $OPT -passes="$PREPASSES" -S -o $IR
+
+    US=""
+    for ((RUN = 0; RUN < RUNS; RUN++)); do
+        T=$(time_pattern_pass $IR)
+        if [ -z "$US" ] || [ $T -lt $US ]; then
+            US=$T
+        fi
+    done
+
+    $OPT -passes=riscv-biriscv-patterns -S $IR -o $WORK_DIR/reduction_$N.opt.ll
+    SAD_COUNT=$(grep -c "call i32 @llvm\.riscv\.biriscv\.sad(" \
+                $WORK_DIR/reduction_$N.opt.ll || true)
+    echo "  $N terms: ${US} us, $SAD_COUNT SAD instructions"
+
+    if [ -n "$PREV_US" ] && [ $PREV_US -gt 0 ]; then
+        # time(N) / time(PREV_N) must stay below MAX_GROWTH * N / PREV_N
+        if [ $(( US * PREV_N )) -gt $(( MAX_GROWTH * N * PREV_US )) ]; then
+            echo "  ERROR: compile time grew super-linearly from $PREV_N to $N terms"
+            STATUS=1
+        fi
+    fi
+
+    PREV_N=$N
+    PREV_US=$US
+done
+
+echo ""
+if [ $STATUS -eq 0 ]; then
+    echo "PASS: compile time scales linearly with reduction size"
+else
+    echo "FAIL: compile time scales super-linearly with reduction size"
+fi
+echo "=========================================================================="
+
+exit $STATUS
@@ -20,6 +20,7 @@ echo "Motion estimation: 256 blocks x 256 search positions = 65,536 SAD computat
 echo "Total SAD operations: 1,048,576 (16 per block comparison)"
 echo "Convolution operations: ~550,000 MADD operations"
 echo "CRC operations: 3 frames with BREV"
+echo "Mode decision: 2,048 4x4 SATDs with ADD16/SUB16 + SATD4"
 echo ""
 
 # Check if clang exists
@@ -59,6 +60,8 @@ MADD_COUNT=$(grep -c "madd" $ASM_CUSTOM || true)
 TERNLOG_COUNT=$(grep -c "ternlog" $ASM_CUSTOM || true)
 CMOV_COUNT=$(grep -c "cmov" $ASM_CUSTOM || true)
 SAD_COUNT=$(grep -c "sad" $ASM_CUSTOM || true)
+ADDSUB16_COUNT=$(grep -cwE "(add|sub)16" $ASM_CUSTOM || true)
+SATD_COUNT=$(grep -c "satd4" $ASM_CUSTOM || true)
 
 echo ""
 echo "Custom instruction usage:"
@@ -68,6 +71,8 @@ echo "  MADD:    $MADD_COUNT"
 echo "  TERNLOG: $TERNLOG_COUNT"
 echo "  CMOV:    $CMOV_COUNT"
 echo "  SAD:     $SAD_COUNT"
+echo "  ADD16/SUB16: $ADDSUB16_COUNT"
+echo "  SATD4:   $SATD_COUNT"
 echo ""
 
 # Calculate reduction
@@ -0,0 +1,41 @@
+// Test file for splitting MADD and SAD accumulation chains in
+// RISCVBiRiscVPatterns
+// fir25 and block_sad are each one serial chain in a single block. Each should
+// be split into two independent accumulators (MADD and SAD both need 2 on
+// biriscv): the madds/sads alternate between two rs3/rd registers and a
+// single add joins the two sums after the last step.
+//
+//   clang -O2 --target=riscv32 -march=rv32im_xbiriscv0p1 -S test_accumulator_split.c
+//   (add -Rpass=riscv-biriscv-patterns for the "split chain" remarks)
+//
+// With -mllvm -riscv-biriscv-accumulators=1 the chains stay serial: each
+// madd/sad takes the previous one's rd as rs3 and there is no final add.
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// 25-tap FIR (5x5 filter kernel): 25 MADDs -> 13 + 12 and one add
+int32_t fir25(const int32_t *p, const int32_t *k) {
+    int32_t sum = 0;
+#pragma clang loop unroll(full)
+    for (int i = 0; i < 25; i++)
+        sum += p[i] * k[i];
+    return sum;
+}
+
+// 8x8 block SAD: 16 SADs, one per row half -> 8 + 8 and one add
+uint32_t block_sad(const uint8_t *a, const uint8_t *b, int stride) {
+    uint32_t sad = 0;
+#pragma clang loop unroll(full)
+    for (int y = 0; y < 8; y++) {
+#pragma clang loop unroll(full)
+        for (int x = 0; x < 8; x++)
+            sad += abs(a[y * stride + x] - b[y * stride + x]);
+    }
+    return sad;
+}
+
+// Too short to split: a mul and two madds stay one chain
+int32_t dot3(const int32_t *p, const int32_t *k) {
+    return p[0] * k[0] + p[1] * k[1] + p[2] * k[2];
+}
@@ -0,0 +1,73 @@
+// Test file for MADD/CSEL/CMOV/SAD selection when the feeding mul, compare
+// or SAD ends up in another basic block than its user
+//
+//   clang -O2 --target=riscv32 -march=rv32im_xbiriscv0p1 -S test_cross_block_fusion.c
+//   (add -mllvm -stats to see the riscv-biriscv-patterns sink counters)
+
+#include <stdint.h>
+
+//=============================================================================
+// MADD: the product is computed before the branch, the adds are in the arms
+//=============================================================================
+
+// Product used in both arms: one madd per arm
+// (the stores keep the arms from being if-converted)
+void madd_both_arms(int32_t a, int32_t b, int32_t c, int32_t d, int32_t *out) {
+    int32_t p = a * b;
+    if (c > d)
+        out[0] = p + c;   // madd
+    else
+        out[1] = p + d;   // madd
+}
+
+// Product used in a block and again in one it can branch to: one mul, the
+// adds stay plain (two madds would run two multiplies on that path)
+void madd_chained(int32_t a, int32_t b, int32_t c, int32_t *out) {
+    int32_t p = a * b;
+    if (c > 0) {
+        out[0] = p + c;
+        if (c > 10)
+            out[1] = p + 10;
+    }
+}
+
+// Loop-invariant product: stays hoisted, the loop keeps a plain add
+int32_t madd_invariant(const int32_t *x, int n, int32_t a, int32_t b) {
+    int32_t sum = 0;
+    for (int i = 0; i < n; i++)
+        sum += x[i] + a * b;
+    return sum;
+}
+
+//=============================================================================
+// CSEL/CMOV: the compare is in another block than the select
+//=============================================================================
+
+int32_t cmov_after_branch(int32_t a, int32_t b, int32_t x, int32_t *out) {
+    int is_zero = (x == 0);
+    if (out)
+        *out = a;
+    return is_zero ? a : b;   // csel a, b, x
+}
+
+//=============================================================================
+// SAD: the packed SAD is computed before the branch, accumulated in the arms
+//=============================================================================
+
+void sad_after_branch(uint32_t a, uint32_t b, uint32_t acc, uint32_t *out) {
+    uint32_t s = __builtin_riscv_biriscv_sad(a, b, 0);
+    if (acc)
+        out[0] = acc + s;   // sad a, b, acc
+    else
+        out[1] = s + b;     // sad a, b, b
+}
+
+int main(void) {
+    int32_t x[4] = {1, 2, 3, 4};
+    int32_t out[2] = {0, 0};
+    uint32_t sad_out[2];
+    madd_both_arms(3, 4, 5, 6, out);
+    sad_after_branch(0x01020304, 0x04030201, 1, sad_out);
+    return out[0] + out[1] + (int32_t)sad_out[0] +
+           madd_invariant(x, 4, 2, 3) + cmov_after_branch(1, 2, 0, out);
+}
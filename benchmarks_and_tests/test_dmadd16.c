@@ -0,0 +1,68 @@
+// Test file for DMADD16/DMADD16U, the dual 16-bit multiply-accumulate
+// Sums of halfword products should pair up into one dmadd16 (dmadd16u for
+// uint16_t) per two taps, chained through rs3; a lone product stays madd.
+//
+//   clang -O2 --target=riscv32 -march=rv32im_xbiriscv0p1 -S test_dmadd16.c
+//   (add -Rpass=riscv-biriscv-patterns -Rpass-missed=riscv-biriscv-patterns)
+
+#include <stdint.h>
+
+// 4-tap FIR over int16_t samples: one word load per tap pair and operand,
+// two dmadd16
+int32_t fir4(const int16_t *x, const int16_t *h) {
+    return x[0] * h[0] + x[1] * h[1] + x[2] * h[2] + x[3] * h[3];
+}
+
+// Halves of packed registers: one dmadd16 with acc in rs3
+int32_t dot2_packed(uint32_t a, uint32_t b, int32_t acc) {
+    acc += (int16_t)a * (int16_t)b;
+    acc += (int16_t)(a >> 16) * (int16_t)(b >> 16);
+    return acc;
+}
+
+// Unsigned halfwords: dmadd16u
+uint32_t dot2_unsigned(const uint16_t *a, const uint16_t *b) {
+    return (uint32_t)a[0] * b[0] + (uint32_t)a[1] * b[1];
+}
+
+// Odd tap count: one dmadd16, the third product stays madd
+int32_t fir3(const int16_t *x, const int16_t *h) {
+    return x[0] * h[0] + x[1] * h[1] + x[2] * h[2];
+}
+
+// Not a DMADD16: signed times unsigned ("MixedSignedness")
+int32_t dot2_mixed(const int16_t *a, const uint16_t *b) {
+    return a[0] * b[0] + a[1] * b[1];
+}
+
+#ifdef __clang__
+// Builtins
+int32_t dmadd16_builtin(uint32_t a, uint32_t b, int32_t acc) {
+    return __builtin_riscv_biriscv_dmadd16(a, b, acc);
+}
+
+uint32_t dmadd16u_builtin(uint32_t a, uint32_t b, uint32_t acc) {
+    return __builtin_riscv_biriscv_dmadd16u(a, b, acc);
+}
+#endif
+
+int main(void) {
+    int16_t x[4] = {3, -2, 0x7FFF, -0x8000};
+    int16_t h[4] = {5, 4, 2, -0x8000};
+    uint16_t ua[2] = {0x8000, 0xFFFF};
+    uint16_t ub[2] = {0x0002, 0xFFFF};
+    uint16_t um[2] = {2, 3};
+
+    // -0x8000 * -0x8000 = 0x40000000 is the largest signed halfword product
+    int ok = fir4(x, h) == 15 - 8 + 0xFFFE + 0x40000000 &&
+             fir3(x, h) == 15 - 8 + 0xFFFE &&
+             dot2_packed(0x00030002, 0x00050004, 100) == 123 &&
+             dot2_packed(0xFFFF8000, 0x00028000, 0) == 0x3FFFFFFE &&
+             dot2_unsigned(ua, ub) == 0x10000u + 0xFFFE0001u &&
+             dot2_mixed(x, um) == 6 - 6;
+#ifdef __clang__
+    ok &= dmadd16_builtin(0x00030002, 0x00050004, 100) == 123 &&
+          dmadd16u_builtin(0xFFFF8000, 0x00028000, 0) == 0x4001FFFE;
+#endif
+    return ok ? 0 : 1;
+}
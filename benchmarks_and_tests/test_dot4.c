@@ -0,0 +1,117 @@
+// Test file for DOT4/DOT4U/DOT4US, the 4-lane 8-bit dot product-accumulate
+// Byte products should be packed four to a word: dot4 for int8_t x int8_t,
+// dot4u for uint8_t x uint8_t and dot4us for uint8_t x int8_t, chained
+// through rs3, in add trees, in loops and in <4 x i8> reductions.
+//
+//   clang -O2 --target=riscv32 -march=rv32im_xbiriscv0p1 -S test_dot4.c
+//   (add -Rpass=riscv-biriscv-patterns -Rpass-missed=riscv-biriscv-patterns)
+
+#include <stdint.h>
+
+// int8 layer inner loop: a dot4 loop, the original loop handles the last
+// 1-3 elements
+int32_t dot_s8(const int8_t *a, const int8_t *w, int n) {
+    int32_t acc = 0;
+    for (int i = 0; i < n; i++)
+        acc += a[i] * w[i];
+    return acc;
+}
+
+// Quantized activations against signed weights: a dot4us loop
+int32_t dot_u8s8(const uint8_t *a, const int8_t *w, int n) {
+    int32_t acc = 0;
+    for (int i = 0; i < n; i++)
+        acc += a[i] * w[i];
+    return acc;
+}
+
+// Same with the operands the other way round: still dot4us, with the
+// uint8_t array in rs1
+int32_t dot_s8u8(const int8_t *w, const uint8_t *a, int n) {
+    int32_t acc = 0;
+    for (int i = 0; i < n; i++)
+        acc += w[i] * a[i];
+    return acc;
+}
+
+// Four taps of a uint8_t filter plus bias: one word load per operand, one dot4u
+// with the bias in rs3
+int32_t tap4_u8(const uint8_t *px, const uint8_t *k, int32_t bias) {
+    return bias + px[0] * k[0] + px[1] * k[1] + px[2] * k[2] + px[3] * k[3];
+}
+
+// Bytes of packed registers: one dot4
+int32_t dot4_packed(uint32_t a, uint32_t b, int32_t acc) {
+    acc += (int8_t)a * (int8_t)b;
+    acc += (int8_t)(a >> 8) * (int8_t)(b >> 8);
+    acc += (int8_t)(a >> 16) * (int8_t)(b >> 16);
+    acc += (int8_t)(a >> 24) * (int8_t)(b >> 24);
+    return acc;
+}
+
+// Three products in a word: one dot4 with the fourth lane cleared
+int32_t dot3_packed(uint32_t a, uint32_t b) {
+    return (int8_t)a * (int8_t)b + (int8_t)(a >> 8) * (int8_t)(b >> 8) +
+           (int8_t)(a >> 16) * (int8_t)(b >> 16);
+}
+
+// Not a DOT4: a lone byte product stays madd
+int32_t mac1(const int8_t *a, const int8_t *w, int32_t acc) {
+    return acc + a[0] * w[0];
+}
+
+#ifdef __clang__
+typedef int8_t int8x4_t __attribute__((vector_size(4)));
+typedef int32_t int32x4_t __attribute__((vector_size(16)));
+
+// Dot-product reduction of one word: dot4
+int32_t dot_reduce(int8x4_t a, int8x4_t b) {
+    return __builtin_reduce_add(__builtin_convertvector(a, int32x4_t) *
+                                __builtin_convertvector(b, int32x4_t));
+}
+
+// Builtins
+int32_t dot4_builtin(uint32_t a, uint32_t b, int32_t acc) {
+    return __builtin_riscv_biriscv_dot4(a, b, acc);
+}
+
+uint32_t dot4u_builtin(uint32_t a, uint32_t b, uint32_t acc) {
+    return __builtin_riscv_biriscv_dot4u(a, b, acc);
+}
+
+int32_t dot4us_builtin(uint32_t a, uint32_t b, int32_t acc) {
+    return __builtin_riscv_biriscv_dot4us(a, b, acc);
+}
+#endif
+
+int main(void) {
+    int8_t s[11], w[11];
+    uint8_t u[11];
+    int32_t ref_ss = 0, ref_us = 0;
+    for (int i = 0; i < 11; i++) {
+        s[i] = (int8_t)(i * 37 - 128);
+        w[i] = (int8_t)(100 - i * 29);
+        u[i] = (uint8_t)(i * 91 + 7);
+        ref_ss += s[i] * w[i];
+        ref_us += u[i] * w[i];
+    }
+    uint8_t px[4] = {255, 0, 128, 1};
+    uint8_t k[4] = {255, 9, 2, 200};
+
+    // Packed lanes 1, 127, -1, -128 against 2, -127, -1, -128
+    int ok = dot_s8(s, w, 11) == ref_ss &&
+             dot_u8s8(u, w, 11) == ref_us &&
+             dot_s8u8(w, u, 11) == ref_us &&
+             tap4_u8(px, k, -10) == 65025 + 256 + 200 - 10 &&
+             dot4_packed(0x80FF7F01, 0x80FF8102, 0) == 258 &&
+             dot3_packed(0x80FF7F01, 0x80FF8102) == 258 - 16384 &&
+             mac1(s, w, 5) == 5 + s[0] * w[0];
+#ifdef __clang__
+    ok &= dot_reduce((int8x4_t){1, 127, -1, -128},
+                     (int8x4_t){2, -127, -1, -128}) == 258 &&
+          dot4_builtin(0x80FF7F01, 0x80FF8102, 0) == 258 &&
+          dot4u_builtin(0x80FF7F01, 0x80FF8102, 0) == 97794 &&
+          dot4us_builtin(0x80FF7F01, 0x80FF8102, 0) == -32766;
+#endif
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+// Test file for machine-level if-conversion into CSEL/CMOV groups
+// The conditional updates below should compile without a branch: one
+// slt/sltu/xor for the condition and one csel or cmov per updated variable
+//
+//   clang -O2 --target=riscv32 -march=rv32im_xbiriscv0p1 -S test_ifcvt_cmov.c
+//   (add -Rpass=riscv-biriscv-patterns to see the cost of each branch)
+
+#include <stdint.h>
+
+typedef struct {
+    int x;
+    int y;
+    uint32_t cost;
+} Match;
+
+// Best-match update from motion search: three live-outs, one condition
+Match best_match(const uint32_t *costs, int w, int h) {
+    Match best = {0, 0, 0xFFFFFFFF};
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            uint32_t c = costs[y * w + x];
+            if (c < best.cost) {
+                best.x = x;
+                best.y = y;
+                best.cost = c;
+            }
+        }
+    }
+    return best;
+}
+
+// Diamond: both arms compute something
+void minmax_update(int32_t v, int32_t *lo, int32_t *hi, int32_t *span) {
+    int32_t a = *lo, b = *hi, s;
+    if (v < a) {
+        a = v;
+        s = b - v;
+    } else {
+        b = v > b ? v : b;
+        s = b - a;
+    }
+    *lo = a;
+    *hi = b;
+    *span = s;
+}
+
+int main(void) {
+    uint32_t costs[6] = {9, 7, 8, 3, 5, 4};
+    int32_t lo = 5, hi = 5, span = 0;
+    Match m = best_match(costs, 3, 2);
+    minmax_update(2, &lo, &hi, &span);
+    return (m.x == 0 && m.y == 1 && m.cost == 3 && span == 3) ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+// Test file for MIN/MAX/MINU/MAXU and CLIP/CLIPU selection
+// Each min/max below should be a single min/max/minu/maxu, abs a neg plus a
+// max, and a clamp to a power-of-two range a single clip/clipu - no branches
+//
+//   clang -O2 --target=riscv32 -march=rv32im_xbiriscv0p1 -S test_minmax_clamp.c
+//   (add -mllvm -stats to see the MIN/MAX and CLIP counters)
+
+#include <stdint.h>
+
+int32_t smin32(int32_t a, int32_t b) { return a < b ? a : b; }     // min
+int32_t smax32(int32_t a, int32_t b) { return a > b ? a : b; }     // max
+uint32_t umin32(uint32_t a, uint32_t b) { return a < b ? a : b; }  // minu
+uint32_t umax32(uint32_t a, uint32_t b) { return a > b ? a : b; }  // maxu
+int32_t abs32(int32_t x) { return x < 0 ? -x : x; }                // neg + max
+
+// ReLU-style: max against x0
+int32_t relu(int32_t x) { return x > 0 ? x : 0; }
+
+// Pixel clamp after a residual add: clipu x, 8
+uint8_t clamp_u8(int32_t x) {
+    return (uint8_t)(x < 0 ? 0 : (x > 255 ? 255 : x));
+}
+
+// Signed 8-bit saturation: clip x, 7
+int32_t clamp_s8(int32_t x) {
+    if (x < -128) x = -128;
+    if (x > 127) x = 127;
+    return x;
+}
+
+// Builtins map straight to the instructions
+uint32_t builtins(int32_t a, int32_t b) {
+    return (uint32_t)__builtin_riscv_biriscv_min(a, b) +
+           (uint32_t)__builtin_riscv_biriscv_max(a, b) +
+           __builtin_riscv_biriscv_minu((uint32_t)a, (uint32_t)b) +
+           __builtin_riscv_biriscv_maxu((uint32_t)a, (uint32_t)b);
+}
+
+// Not a power-of-two range: max + min
+int32_t clamp_10_200(int32_t x) {
+    return x < 10 ? 10 : (x > 200 ? 200 : x);
+}
+
+// Builtins for explicit saturation, e.g. 10-bit video samples
+uint32_t clip_builtins(int32_t x) {
+    return __builtin_riscv_biriscv_clipu(x, 10) +
+           (uint32_t)__builtin_riscv_biriscv_clip(x, 15);
+}
+
+// Reconstruct a row of pixels: prediction + residual, clamped
+void reconstruct_row(uint8_t *dst, const uint8_t *pred, const int16_t *res,
+                     int n) {
+    for (int i = 0; i < n; i++)
+        dst[i] = clamp_u8(pred[i] + res[i]);
+}
+
+// Median of three, as used by median filters: 4 min/max, no branches
+int32_t median3(int32_t a, int32_t b, int32_t c) {
+    int32_t lo = a < b ? a : b;
+    int32_t hi = a < b ? b : a;
+    hi = hi < c ? hi : c;
+    return lo > hi ? lo : hi;
+}
+
+int main(void) {
+    uint8_t pred[4] = {10, 250, 0, 128};
+    int16_t res[4] = {-20, 20, 5, 0};
+    uint8_t dst[4];
+    reconstruct_row(dst, pred, res, 4);
+    int ok = dst[0] == 0 && dst[1] == 255 && dst[2] == 5 && dst[3] == 128;
+    ok &= smin32(-3, 2) == -3 && smax32(-3, 2) == 2;
+    ok &= umin32(1, 0xFFFFFFFFu) == 1 && umax32(1, 0xFFFFFFFFu) == 0xFFFFFFFFu;
+    ok &= abs32(-7) == 7 && relu(-7) == 0;
+    ok &= clamp_s8(-300) == -128 && clamp_s8(300) == 127 && clamp_s8(5) == 5;
+    ok &= builtins(-1, 1) == (uint32_t)(-1 + 1 + 1 + 0xFFFFFFFFu);
+    ok &= clamp_10_200(3) == 10 && clamp_10_200(300) == 200;
+    ok &= clip_builtins(2000) == 1023 + 2000 && clip_builtins(-5) == (uint32_t)-5;
+    ok &= median3(3, 9, 5) == 5 && median3(9, 3, 1) == 3;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+// Test file for packed loops over uint8_t/uint16_t arrays
+// Element-wise loops below should get a loop in front of them that does one
+// word load per source, one packed instruction per operation and one word
+// store per four bytes (two halfwords); the original loop handles the rest
+//
+//   clang -O2 --target=riscv32 -march=rv32im_xbiriscv0p1 -S test_packed_loops.c
+//   (add -Rpass=riscv-biriscv-patterns -Rpass-missed=riscv-biriscv-patterns)
+
+#include <stdint.h>
+
+// Bi-prediction: avgu.b
+void avg_rows(uint8_t *dst, const uint8_t *a, const uint8_t *b, int n) {
+    for (int i = 0; i < n; i++)
+        dst[i] = (uint8_t)((a[i] + b[i] + 1) >> 1);
+}
+
+// Saturating brighten by a loop-invariant amount: addus.b with the amount
+// splatted across the word once, in place
+void brighten(uint8_t *px, uint8_t delta, int n) {
+    for (int i = 0; i < n; i++) {
+        unsigned s = px[i] + delta;
+        px[i] = s > 255 ? 255 : (uint8_t)s;
+    }
+}
+
+// Lane min/max: maxu.b, minu.b
+void clamp_rows(uint8_t *dst, const uint8_t *src, const uint8_t *lo,
+                const uint8_t *hi, int n) {
+    for (int i = 0; i < n; i++) {
+        uint8_t v = src[i] < lo[i] ? lo[i] : src[i];
+        dst[i] = v > hi[i] ? hi[i] : v;
+    }
+}
+
+// 10-bit residual reconstruction, wrapping halfword adds: add16
+void add_residual(uint16_t *dst, const uint16_t *pred, const uint16_t *res,
+                  int n) {
+    for (int i = 0; i < n; i++)
+        dst[i] = (uint16_t)(pred[i] + res[i]);
+}
+
+// Not converted: the sum is live out of the loop ("LiveOut")
+uint8_t last_avg(uint8_t *dst, const uint8_t *a, const uint8_t *b, int n) {
+    uint8_t v = 0;
+    for (int i = 0; i < n; i++)
+        dst[i] = v = (uint8_t)((a[i] + b[i] + 1) >> 1);
+    return v;
+}
+
+#ifdef __clang__
+typedef uint8_t uint8x4_t __attribute__((vector_size(4)));
+typedef int16_t int16x4_t __attribute__((vector_size(8)));
+
+// Abs-diff reduction of one word: sad
+int32_t sad_reduce(uint8x4_t a, uint8x4_t b) {
+    int16x4_t d = __builtin_convertvector(a, int16x4_t) -
+                  __builtin_convertvector(b, int16x4_t);
+    return __builtin_reduce_add(__builtin_elementwise_abs(d));
+}
+#endif
+
+int main(void) {
+    uint8_t a[11], b[11], dst[11], lo[11], hi[11];
+    uint16_t pred[7], res[7], rec[7];
+    for (int i = 0; i < 11; i++) {
+        a[i] = (uint8_t)(i * 37 + 200);
+        b[i] = (uint8_t)(i * 91);
+        lo[i] = 40;
+        hi[i] = 200;
+    }
+    for (int i = 0; i < 7; i++) {
+        pred[i] = (uint16_t)(i * 150);
+        res[i] = (uint16_t)(0xFFFF - i * 20);
+    }
+
+    int ok = 1;
+    avg_rows(dst, a, b, 11);
+    for (int i = 0; i < 11; i++)
+        ok &= dst[i] == (uint8_t)((a[i] + b[i] + 1) >> 1);
+
+    clamp_rows(dst, a, lo, hi, 11);
+    for (int i = 0; i < 11; i++)
+        ok &= dst[i] >= 40 && dst[i] <= 200 &&
+              (dst[i] == a[i] || a[i] < 40 || a[i] > 200);
+
+    add_residual(rec, pred, res, 7);
+    for (int i = 0; i < 7; i++)
+        ok &= rec[i] == (uint16_t)(i * 130 - 1);
+
+    brighten(a, 100, 11);
+    for (int i = 0; i < 11; i++) {
+        unsigned s = (uint8_t)(i * 37 + 200) + 100u;
+        ok &= a[i] == (s > 255 ? 255 : s);
+    }
+
+    ok &= last_avg(dst, b, b, 11) == b[10];
+#ifdef __clang__
+    ok &= sad_reduce((uint8x4_t){0, 255, 10, 3},
+                     (uint8x4_t){255, 0, 3, 10}) == 524;
+#endif
+    return ok ? 0 : 1;
+}
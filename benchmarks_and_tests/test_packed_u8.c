@@ -0,0 +1,81 @@
+// Test file for the packed 8-bit instructions (ADD.B ... MAXU.B)
+// uint8x4_t arithmetic should compile to one add.b/sub.b/addus.b/subus.b/
+// avgu.b/minu.b/maxu.b per operation on the word holding the four lanes,
+// not four byte operations
+//
+//   clang -O2 --target=riscv32 -march=rv32im_xbiriscv0p1 -S test_packed_u8.c
+
+#include <stdint.h>
+
+typedef uint8_t uint8x4_t __attribute__((vector_size(4)));
+typedef uint16_t uint16x4_t __attribute__((vector_size(8)));
+
+// Wrapping lane arithmetic: add.b, sub.b
+uint8x4_t add_sub(uint8x4_t a, uint8x4_t b, uint8x4_t c) {
+    return a + b - c;
+}
+
+// Lane min/max written with compare masks (C has no vector ?:), which
+// InstCombine turns into umax/umin: maxu.b, minu.b
+uint8x4_t clamp_lanes(uint8x4_t x, uint8x4_t lo, uint8x4_t hi) {
+    uint8x4_t m = (uint8x4_t)(x < lo);
+    x = (lo & m) | (x & ~m);
+    m = (uint8x4_t)(x > hi);
+    return (hi & m) | (x & ~m);
+}
+
+// Rounding average computed in wider lanes: avgu.b
+uint8x4_t avg_round(uint8x4_t a, uint8x4_t b) {
+    uint16x4_t s = __builtin_convertvector(a, uint16x4_t) +
+                   __builtin_convertvector(b, uint16x4_t) + 1;
+    return __builtin_convertvector(s >> 1, uint8x4_t);
+}
+
+// Bi-prediction of a row: one word load per operand, one avgu.b per four
+// pixels, one word store
+void bipred_row(uint8_t *dst, const uint8_t *p0, const uint8_t *p1, int n) {
+    for (int i = 0; i < n; i += 4) {
+        uint8x4_t a = *(const uint8x4_t *)(p0 + i);
+        uint8x4_t b = *(const uint8x4_t *)(p1 + i);
+        *(uint8x4_t *)(dst + i) = avg_round(a, b);
+    }
+}
+
+// Builtins: saturating brighten/darken has no generic C form
+uint8x4_t brighten(uint8x4_t px, uint8x4_t delta) {
+    return __builtin_riscv_biriscv_addus_b(px, delta);
+}
+
+uint8x4_t darken(uint8x4_t px, uint8x4_t delta) {
+    return __builtin_riscv_biriscv_subus_b(px, delta);
+}
+
+uint8x4_t avg_builtin(uint8x4_t a, uint8x4_t b) {
+    return __builtin_riscv_biriscv_avgu_b(a, b);
+}
+
+static int same(uint8x4_t a, uint8x4_t b) {
+    return a[0] == b[0] && a[1] == b[1] && a[2] == b[2] && a[3] == b[3];
+}
+
+int main(void) {
+    uint8x4_t a = {0x01, 0x7F, 0x80, 0xF0};
+    uint8x4_t b = {0x02, 0x80, 0xFF, 0x20};
+    uint8x4_t z = {0, 0, 0, 0};
+    uint8x4_t lo = {0x10, 0x10, 0x10, 0x10};
+    uint8x4_t hi = {0xE0, 0xE0, 0xE0, 0xE0};
+
+    uint8_t p0[8] = {0, 1, 2, 255, 10, 20, 30, 40};
+    uint8_t p1[8] = {0, 0, 3, 255, 11, 21, 31, 41};
+    uint8_t dst[8];
+    bipred_row(dst, p0, p1, 8);
+
+    int ok = same(add_sub(a, b, z), (uint8x4_t){0x03, 0xFF, 0x7F, 0x10}) &&
+             same(clamp_lanes(a, lo, hi), (uint8x4_t){0x10, 0x7F, 0x80, 0xE0}) &&
+             same(avg_round(a, b), (uint8x4_t){0x02, 0x80, 0xC0, 0x88}) &&
+             same(brighten(a, b), (uint8x4_t){0x03, 0xFF, 0xFF, 0xFF}) &&
+             same(darken(a, b), (uint8x4_t){0x00, 0x00, 0x00, 0xD0}) &&
+             same(avg_builtin(a, b), avg_round(a, b)) &&
+             dst[1] == 1 && dst[3] == 255 && dst[7] == 41;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+// Test file for SAD16, the halfword SAD
+// Abs-diffs of uint16_t lanes (10/12-bit video, packed halfwords) should
+// become sad16, two lanes per word; the byte versions stay sad.
+//
+//   clang -O2 --target=riscv32 -march=rv32im_xbiriscv0p1 -S test_sad16.c
+//   (add -Rpass=riscv-biriscv-patterns -Rpass-missed=riscv-biriscv-patterns)
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Packed halfword lanes: one sad16
+int32_t sad16_packed(uint32_t a, uint32_t b, int32_t acc) {
+    acc += abs((int32_t)(a & 0xFFFF) - (int32_t)(b & 0xFFFF));
+    acc += abs((int32_t)(a >> 16) - (int32_t)(b >> 16));
+    return acc;
+}
+
+// Same through uint16_t casts: one sad16
+int32_t sad16_cast(uint32_t a, uint32_t b) {
+    return abs((uint16_t)a - (uint16_t)b) +
+           abs((uint16_t)(a >> 16) - (uint16_t)(b >> 16));
+}
+
+// 10-bit 4x4 block: one word load per halfword pair and operand, eight
+// sad16 chained through rs3
+int32_t sad16_4x4(const uint16_t *cur, const uint16_t *ref, int stride) {
+    int32_t acc = 0;
+    for (int y = 0; y < 4; y++)
+        for (int x = 0; x < 4; x++)
+            acc += abs(cur[y * stride + x] - ref[y * stride + x]);
+    return acc;
+}
+
+// Row of 12-bit samples: a sad16 loop, the original loop handles the last
+// sample of an odd count
+int32_t sad16_row(const uint16_t *a, const uint16_t *b, int n) {
+    int32_t sum = 0;
+    for (int i = 0; i < n; i++)
+        sum += abs(a[i] - b[i]);
+    return sum;
+}
+
+// Not a SAD16: signed halfwords ("SignedHalfwords")
+int32_t sad16_signed(const int16_t *a, const int16_t *b) {
+    return abs(a[0] - b[0]) + abs(a[1] - b[1]);
+}
+
+// Builtin
+int32_t sad16_builtin(uint32_t a, uint32_t b, int32_t acc) {
+    return __builtin_riscv_biriscv_sad16(a, b, acc);
+}
+
+int main(void) {
+    uint16_t cur[16], ref[16];
+    for (int i = 0; i < 16; i++) {
+        cur[i] = (uint16_t)((i * 311) & 0x3FF);
+        ref[i] = (uint16_t)((1000 - i * 57) & 0x3FF);
+    }
+    // Lanes 0x0001, 0xFFFF against 0xFFFF, 0x0001: 0xFFFE + 0xFFFE
+    int ok = sad16_packed(0xFFFF0001, 0x0001FFFF, 0) == 0x1FFFC &&
+             sad16_cast(0xFFFF0001, 0x0001FFFF) == 0x1FFFC &&
+             sad16_builtin(0xFFFF0001, 0x0001FFFF, 0) == 0x1FFFC &&
+             sad16_4x4(cur, ref, 4) == sad16_row(cur, ref, 16) &&
+             sad16_signed((const int16_t *)cur, (const int16_t *)ref) >= 0;
+    return ok ? 0 : 1;
+}
@@ -32,6 +32,16 @@ uint32_t test_sad_literals(void) {
     return __builtin_riscv_biriscv_sad(0x01020304, 0x01020305, 0);
 }
 
+// Signed byte lanes
+int32_t test_sads_basic(uint32_t a, uint32_t b, int32_t acc) {
+    return __builtin_riscv_biriscv_sads(a, b, acc);
+}
+
+// Halfword lanes
+int32_t test_sad16_basic(uint32_t a, uint32_t b, int32_t acc) {
+    return __builtin_riscv_biriscv_sad16(a, b, acc);
+}
+
 // Inline comparison and decision
 uint32_t find_best_match(uint32_t current, uint32_t candidate1, uint32_t candidate2) {
     uint32_t sad1 = __builtin_riscv_biriscv_sad(current, candidate1, 0);
@@ -0,0 +1,74 @@
+// Test file for loop-level SAD formation in RISCVBiRiscVPatterns
+// Natural byte abs-diff reduction loops should become a SAD loop over
+// word loads, with the original loop kept as the scalar epilogue.
+//
+// Compile with:
+//   clang -O3 --target=riscv32 -march=rv32im_xbiriscv0p1 -S test_sad_loop.c
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Constant trip count, multiple of 4 (no remainder)
+uint32_t sad_loop_64(const uint8_t *a, const uint8_t *b) {
+    uint32_t sad = 0;
+    for (int i = 0; i < 64; i++)
+        sad += abs(a[i] - b[i]);
+    return sad;
+}
+
+// Runtime trip count with remainder handled by the scalar loop
+uint32_t sad_loop_n(const uint8_t *a, const uint8_t *b, int n) {
+    uint32_t sad = 0;
+    for (int i = 0; i < n; i++)
+        sad += abs(a[i] - b[i]);
+    return sad;
+}
+
+// Select-based abs-diff with an incoming accumulator
+uint32_t sad_loop_acc(const uint8_t *a, const uint8_t *b, int n, uint32_t acc) {
+    for (int i = 0; i < n; i++) {
+        uint8_t x = a[i], y = b[i];
+        acc += (x > y) ? (x - y) : (y - x);
+    }
+    return acc;
+}
+
+// Pointer-increment form
+uint32_t sad_loop_ptr(const uint8_t *a, const uint8_t *b, const uint8_t *end) {
+    uint32_t sad = 0;
+    while (a != end)
+        sad += abs(*a++ - *b++);
+    return sad;
+}
+
+// Word-aligned local buffers: the alignment check folds away
+uint32_t sad_loop_local(const uint8_t *frame, int stride) {
+    uint8_t cur[16], ref[16];
+    for (int i = 0; i < 16; i++) {
+        cur[i] = frame[i];
+        ref[i] = frame[i + stride];
+    }
+
+    uint32_t sad = 0;
+    for (int i = 0; i < 16; i++)
+        sad += abs(cur[i] - ref[i]);
+    return sad;
+}
+
+// Signed bytes: a SADS loop
+int32_t sad_loop_signed(const int8_t *a, const int8_t *b, int n) {
+    int32_t sad = 0;
+    for (int i = 0; i < n; i++)
+        sad += abs(a[i] - b[i]);
+    return sad;
+}
+
+// Not a SAD loop: the select picks the negative difference, -|a[i] - b[i]|
+int32_t neg_sad_loop(const uint8_t *a, const uint8_t *b, int n) {
+    int32_t acc = 0;
+    for (int i = 0; i < n; i++) {
+        uint8_t x = a[i], y = b[i];
+        acc += (x < y) ? (x - y) : (y - x);
+    }
+    return acc;
+}
@@ -42,7 +42,7 @@ uint32_t manual_sad_packed(uint32_t a, uint32_t b, uint32_t acc) {
     return acc;
 }
 
-// Using custom abs function
+// Using custom abs function on signed bytes: becomes SADS
 uint32_t manual_sad_abs(uint32_t a, uint32_t b, uint32_t acc) {
     int8_t a0 = (a >> 0) & 0xFF;
     int8_t a1 = (a >> 8) & 0xFF;
@@ -66,3 +66,105 @@ uint32_t manual_sad_abs(uint32_t a, uint32_t b, uint32_t acc) {
 uint32_t builtin_sad(uint32_t a, uint32_t b, uint32_t acc) {
     return __builtin_riscv_biriscv_sad(a, b, acc);
 }
+
+// Memory-sourced SAD at a non-zero offset: one word load per operand
+uint32_t manual_sad_offset(const uint32_t *a, const uint32_t *b, uint32_t acc) {
+    const uint8_t *pa = (const uint8_t *)&a[1];
+    const uint8_t *pb = (const uint8_t *)&b[1];
+    acc += absdiff_u8(pa[0], pb[0]);
+    acc += absdiff_u8(pa[1], pb[1]);
+    acc += absdiff_u8(pa[2], pb[2]);
+    acc += absdiff_u8(pa[3], pb[3]);
+    return acc;
+}
+
+// Multi-index GEP into a 2D block (row stride 8)
+uint32_t manual_sad_2d(const uint8_t a[8][8], const uint8_t b[8][8], int row) {
+    uint32_t acc = 0;
+    acc += absdiff_u8(a[row][4], b[row][4]);
+    acc += absdiff_u8(a[row][5], b[row][5]);
+    acc += absdiff_u8(a[row][6], b[row][6]);
+    acc += absdiff_u8(a[row][7], b[row][7]);
+    return acc;
+}
+
+// Induction-variable offsets (the shape left behind by unrolling by 4)
+uint32_t manual_sad_indexed(const uint8_t *a, const uint8_t *b, int n) {
+    uint32_t acc = 0;
+    for (int i = 0; i < n; i += 4) {
+        acc += absdiff_u8(a[i + 0], b[i + 0]);
+        acc += absdiff_u8(a[i + 1], b[i + 1]);
+        acc += absdiff_u8(a[i + 2], b[i + 2]);
+        acc += absdiff_u8(a[i + 3], b[i + 3]);
+    }
+    return acc;
+}
+
+// 8-byte row: two SADs chained through the accumulator
+uint32_t manual_sad_row8(const uint8_t *a, const uint8_t *b) {
+    uint32_t acc = 0;
+    for (int i = 0; i < 8; i++)
+        acc += absdiff_u8(a[i], b[i]);
+    return acc;
+}
+
+// 16-byte row as one balanced tree: four chained SADs
+uint32_t manual_sad_row16(const uint8_t *a, const uint8_t *b) {
+    uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int i = 0; i < 16; i += 4) {
+        s0 += absdiff_u8(a[i + 0], b[i + 0]);
+        s1 += absdiff_u8(a[i + 1], b[i + 1]);
+        s2 += absdiff_u8(a[i + 2], b[i + 2]);
+        s3 += absdiff_u8(a[i + 3], b[i + 3]);
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+// Two packed registers per operand, terms interleaved
+uint32_t manual_sad_two_words(uint32_t a0, uint32_t a1, uint32_t b0, uint32_t b1) {
+    uint32_t acc = 0;
+    for (int i = 0; i < 4; i++) {
+        acc += absdiff_u8((a0 >> (8 * i)) & 0xFF, (b0 >> (8 * i)) & 0xFF);
+        acc += absdiff_u8((a1 >> (8 * i)) & 0xFF, (b1 >> (8 * i)) & 0xFF);
+    }
+    return acc;
+}
+
+// 10 bytes: two SADs, the last two terms stay scalar
+uint32_t manual_sad_row10(const uint8_t *a, const uint8_t *b, uint32_t acc) {
+    for (int i = 0; i < 10; i++)
+        acc += absdiff_u8(a[i], b[i]);
+    return acc;
+}
+
+// RGB24 pixel: three lanes, the fourth cleared on both operands
+uint32_t manual_sad_rgb24(const uint8_t *p, const uint8_t *q, uint32_t acc) {
+    acc += absdiff_u8(p[0], q[0]);
+    acc += absdiff_u8(p[1], q[1]);
+    acc += absdiff_u8(p[2], q[2]);
+    return acc;
+}
+
+// RGB24 pixels in 3-byte buffers: the three bytes are loaded separately,
+// a word load would read past the end of the buffers
+uint8_t rgb24_cur[3], rgb24_ref[3];
+
+uint32_t manual_sad_rgb24_buffer(void) {
+    return absdiff_u8(rgb24_cur[0], rgb24_ref[0]) +
+           absdiff_u8(rgb24_cur[1], rgb24_ref[1]) +
+           absdiff_u8(rgb24_cur[2], rgb24_ref[2]);
+}
+
+// 6-pixel chroma row: one full SAD plus a two-lane masked SAD
+uint32_t manual_sad_row6(const uint8_t *a, const uint8_t *b) {
+    uint32_t acc = 0;
+    for (int i = 0; i < 6; i++)
+        acc += absdiff_u8(a[i], b[i]);
+    return acc;
+}
+
+// Partial lanes of packed registers (bytes 1 and 2 only)
+uint32_t manual_sad_mid_lanes(uint32_t a, uint32_t b) {
+    return absdiff_u8((a >> 8) & 0xFF, (b >> 8) & 0xFF) +
+           absdiff_u8((a >> 16) & 0xFF, (b >> 16) & 0xFF);
+}
@@ -0,0 +1,79 @@
+// Test file for SADS, the signed-byte SAD
+// Abs-diffs of int8_t lanes (prediction residuals, 8-bit audio) should become
+// sads; the same code on uint8_t lanes stays sad. A group never mixes the two.
+//
+//   clang -O2 --target=riscv32 -march=rv32im_xbiriscv0p1 -S test_sad_signed.c
+//   (add -Rpass=riscv-biriscv-patterns -Rpass-missed=riscv-biriscv-patterns)
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Packed signed lanes: one sads
+int32_t sads_packed(uint32_t a, uint32_t b, int32_t acc) {
+    acc += abs((int8_t)(a >> 0) - (int8_t)(b >> 0));
+    acc += abs((int8_t)(a >> 8) - (int8_t)(b >> 8));
+    acc += abs((int8_t)(a >> 16) - (int8_t)(b >> 16));
+    acc += abs((int8_t)(a >> 24) - (int8_t)(b >> 24));
+    return acc;
+}
+
+// Same bytes read unsigned: one sad
+int32_t sad_packed(uint32_t a, uint32_t b, int32_t acc) {
+    acc += abs((uint8_t)(a >> 0) - (uint8_t)(b >> 0));
+    acc += abs((uint8_t)(a >> 8) - (uint8_t)(b >> 8));
+    acc += abs((uint8_t)(a >> 16) - (uint8_t)(b >> 16));
+    acc += abs((uint8_t)(a >> 24) - (uint8_t)(b >> 24));
+    return acc;
+}
+
+// Residual energy of a 4x4 block: one word load per row and operand, four
+// sads chained through rs3
+int32_t residual_sad_4x4(const int8_t *res, const int8_t *pred, int stride) {
+    int32_t acc = 0;
+    for (int y = 0; y < 4; y++)
+        for (int x = 0; x < 4; x++)
+            acc += abs(res[y * stride + x] - pred[y * stride + x]);
+    return acc;
+}
+
+// 8-bit audio: a sads loop, the original loop handles the last 0-3 samples
+int32_t audio_diff(const int8_t *a, const int8_t *b, int n) {
+    int32_t sum = 0;
+    for (int i = 0; i < n; i++)
+        sum += abs(a[i] - b[i]);
+    return sum;
+}
+
+// Two signed and two unsigned lanes of the same words: a partial sads and a
+// partial sad
+int32_t sad_mixed_groups(uint32_t a, uint32_t b) {
+    return abs((int8_t)(a >> 0) - (int8_t)(b >> 0)) +
+           abs((int8_t)(a >> 8) - (int8_t)(b >> 8)) +
+           abs((uint8_t)(a >> 16) - (uint8_t)(b >> 16)) +
+           abs((uint8_t)(a >> 24) - (uint8_t)(b >> 24));
+}
+
+// Not a SAD: a signed byte against an unsigned one ("MixedSignedness")
+int32_t sad_mixed_operands(const int8_t *a, const uint8_t *b) {
+    return abs(a[0] - b[0]) + abs(a[1] - b[1]) + abs(a[2] - b[2]) +
+           abs(a[3] - b[3]);
+}
+
+// Builtin
+int32_t sads_builtin(uint32_t a, uint32_t b, int32_t acc) {
+    return __builtin_riscv_biriscv_sads(a, b, acc);
+}
+
+int main(void) {
+    int8_t res[16], pred[16];
+    for (int i = 0; i < 16; i++) {
+        res[i] = (int8_t)(i * 37 - 100);
+        pred[i] = (int8_t)(50 - i * 11);
+    }
+    // Lanes 1, -1, -128, 127 against -1, 1, 127, -128: 2 + 2 + 255 + 255
+    int ok = sads_packed(0x7F80FF01, 0x807F01FF, 0) == 514 &&
+             sad_packed(0x7F80FF01, 0x807F01FF, 0) == 510 &&
+             sads_builtin(0x7F80FF01, 0x807F01FF, 0) == 514 &&
+             residual_sad_4x4(res, pred, 4) == audio_diff(res, pred, 16);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+// Test file for choosing between CSEL/CMOV and a branch
+// Selects stay CSEL/CMOV unless branch weights say the condition is
+// predictable and the unlikely operand is slow to compute
+//
+//   clang -O2 --target=riscv32 -march=rv32im_xbiriscv0p1 -S test_select_vs_branch.c
+//   (add -Rpass=riscv-biriscv-patterns -Rpass-missed=riscv-biriscv-patterns)
+
+#include <stdint.h>
+
+#define likely(x)   __builtin_expect(!!(x), 1)
+#define unlikely(x) __builtin_expect(!!(x), 0)
+
+// Predictable, divide on the unlikely side: branch around the divide
+int32_t scale_rare(int32_t x, int32_t d) {
+    int32_t q = x / d;          // always computed in the source
+    return likely(d == 1) ? x : q;
+}
+
+// Predictable, load on the unlikely side: branch around the load
+int32_t lookup_rare(const int32_t *table, int32_t i, int32_t dflt) {
+    int32_t v = table[i & 3];   // always loaded in the source
+    return unlikely(i >= 0) ? v : dflt;
+}
+
+// Predictable, but both sides are cheap: stays CMOV
+int32_t cheap_predictable(int32_t a, int32_t b, int32_t c) {
+    return likely(c != 0) ? a + 1 : b - 1;
+}
+
+// No branch weights: assumed unpredictable, stays CMOV even with a divide
+int32_t scale_unknown(int32_t x, int32_t d) {
+    int32_t q = x / d;
+    return d == 1 ? x : q;
+}
+
+int main(void) {
+    int32_t table[4] = {10, 20, 30, 40};
+    return scale_rare(12, 3) + lookup_rare(table, 2, 0) +
+           cheap_predictable(1, 2, 3) + scale_unknown(12, 4);
+}
@@ -0,0 +1,63 @@
+// Test file for automatic TERNLOG/TERNLOG3 selection
+// Every function below should compile to a single ternlog or ternlog3
+//
+//   clang -O2 --target=riscv32 -march=rv32im_xbiriscv0p1 -S test_ternlog_pattern.c
+
+#include <stdint.h>
+
+//=============================================================================
+// Two inputs: TERNLOG (third LUT input is 0)
+//=============================================================================
+
+// a & ~b -> imm8 = 0x30
+uint32_t andn(uint32_t a, uint32_t b) {
+    return a & ~b;
+}
+
+// ~(a | b) -> imm8 = 0x03
+uint32_t nor(uint32_t a, uint32_t b) {
+    return ~(a | b);
+}
+
+// ~(a ^ b) -> imm8 = 0xC3
+uint32_t xnor(uint32_t a, uint32_t b) {
+    return ~(a ^ b);
+}
+
+// ~(a & b) -> imm8 = 0x3F
+uint32_t nand(uint32_t a, uint32_t b) {
+    return ~(a & b);
+}
+
+//=============================================================================
+// Three inputs: TERNLOG3 (third LUT input is the old rd)
+//=============================================================================
+
+// Bit select: m ? a : b, bit by bit
+uint32_t bit_select(uint32_t a, uint32_t b, uint32_t m) {
+    return (a & m) | (b & ~m);
+}
+
+// SHA-2 Ch(e, f, g)
+uint32_t sha256_ch(uint32_t e, uint32_t f, uint32_t g) {
+    return (e & f) ^ (~e & g);
+}
+
+// SHA-2 Maj(a, b, c)
+uint32_t sha256_maj(uint32_t a, uint32_t b, uint32_t c) {
+    return (a & b) ^ (a & c) ^ (b & c);
+}
+
+// 3-way XOR (SHA-1 parity, CRC)
+uint32_t xor3(uint32_t a, uint32_t b, uint32_t c) {
+    return a ^ b ^ c;
+}
+
+//=============================================================================
+// Builtin
+//=============================================================================
+
+// LUT index is {a, b, c}; 0xE8 is the 3-input majority
+uint32_t ternlog3_builtin_maj(uint32_t a, uint32_t b, uint32_t c) {
+    return __builtin_riscv_biriscv_ternlog3(a, b, c, 0xE8);
+}
@@ -0,0 +1,57 @@
+// Test file for the two-input TERNLOG DAG combine
+// Every function in the first section should compile to a single ternlog with
+// the imm8 in its comment (rs1 = a, rs2 = b); the functions in the second
+// section save nothing with TERNLOG and must keep their base instructions
+//
+//   clang -O2 --target=riscv32 -march=rv32im_xbiriscv0p1 -S test_ternlog_two_input.c
+//   (5 ternlog lines; with _zbb added andn/orn/xnor stay Zbb instructions)
+
+#include <stdint.h>
+
+//=============================================================================
+// Two or more base instructions: one TERNLOG
+//=============================================================================
+
+// a & ~b: not + and -> imm8 = 0x30
+uint32_t andn(uint32_t a, uint32_t b) {
+    return a & ~b;
+}
+
+// a | ~b: not + or -> imm8 = 0xF3
+uint32_t orn(uint32_t a, uint32_t b) {
+    return a | ~b;
+}
+
+// ~(a ^ b): xor + not -> imm8 = 0xC3
+uint32_t xnor(uint32_t a, uint32_t b) {
+    return ~(a ^ b);
+}
+
+// ~(a & b): and + not -> imm8 = 0x3F
+uint32_t nand(uint32_t a, uint32_t b) {
+    return ~(a & b);
+}
+
+// ~(a | b): or + not -> imm8 = 0x03
+uint32_t nor(uint32_t a, uint32_t b) {
+    return ~(a | b);
+}
+
+//=============================================================================
+// One base instruction: no TERNLOG
+//=============================================================================
+
+// a & ~b | ~a & b is a ^ b, already a single xor
+uint32_t xor_from_and_or(uint32_t a, uint32_t b) {
+    return (a & ~b) | (~a & b);
+}
+
+// Single and
+uint32_t and2(uint32_t a, uint32_t b) {
+    return a & b;
+}
+
+// Constant operand: andi, not li + ternlog
+uint32_t and_imm(uint32_t a) {
+    return a & 0xFF;
+}
@@ -9,12 +9,14 @@
  * - Filtering: Hundreds of MADD operations per frame
  * - CRC validation: BREV for bit reversal
  * - Best match selection: CMOV for branchless comparison
+ * - Mode decision: SATD (4x4 Hadamard) with ADD16/SUB16 + SATD4
  *
  * Expected improvements:
  * - SAD: 18-20x faster (36 inst → 2 inst per operation)
  * - MADD: 2x faster (2 inst → 1 inst per operation)
  * - BREV: 50x faster (50 inst → 1 inst)
  * - CMOV: 5x faster (5 inst → 1 inst)
+ * - SATD: ~5x faster (~100 inst → 20 inst per 4x4 transform)
  *
  * Compile:
  *   Standard:  clang -O3 -march=rv32im video_motion_benchmark.c -S -o standard.s
@@ -331,6 +333,113 @@ static void histogram_equalize(uint8_t *frame) {
     }
 }
 
+//==============================================================================
+// CORE FUNCTION 6: SATD for Mode Decision (Uses ADD16/SUB16 + SATD4)
+//==============================================================================
+
+// Sum of absolute 4x4 Hadamard-transformed differences, halved as in x264.
+// With XBiRiscV the residual rows are packed two columns per word: the
+// vertical butterflies are ADD16/SUB16 on both columns of a word at once,
+// and SATD4 does the horizontal transform and magnitude sum of one row.
+__attribute__((noinline))
+static uint32_t satd_4x4(const uint8_t *a, const uint8_t *b) {
+#ifdef __riscv_xbiriscv
+    uint32_t lo[4], hi[4];  // Columns 0-1 and 2-3 of each residual row
+    for (int y = 0; y < 4; y++) {
+        const uint8_t *pa = &a[y * FRAME_WIDTH];
+        const uint8_t *pb = &b[y * FRAME_WIDTH];
+        lo[y] = (uint16_t)(pa[0] - pb[0]) | (uint32_t)(pa[1] - pb[1]) << 16;
+        hi[y] = (uint16_t)(pa[2] - pb[2]) | (uint32_t)(pa[3] - pb[3]) << 16;
+    }
+
+    uint32_t s01_lo = __builtin_riscv_biriscv_add16(lo[0], lo[1]);
+    uint32_t d01_lo = __builtin_riscv_biriscv_sub16(lo[0], lo[1]);
+    uint32_t s23_lo = __builtin_riscv_biriscv_add16(lo[2], lo[3]);
+    uint32_t d23_lo = __builtin_riscv_biriscv_sub16(lo[2], lo[3]);
+    uint32_t s01_hi = __builtin_riscv_biriscv_add16(hi[0], hi[1]);
+    uint32_t d01_hi = __builtin_riscv_biriscv_sub16(hi[0], hi[1]);
+    uint32_t s23_hi = __builtin_riscv_biriscv_add16(hi[2], hi[3]);
+    uint32_t d23_hi = __builtin_riscv_biriscv_sub16(hi[2], hi[3]);
+
+    int32_t sum = 0;
+    sum = __builtin_riscv_biriscv_satd4(__builtin_riscv_biriscv_add16(s01_lo, s23_lo),
+                                        __builtin_riscv_biriscv_add16(s01_hi, s23_hi), sum);
+    sum = __builtin_riscv_biriscv_satd4(__builtin_riscv_biriscv_add16(d01_lo, d23_lo),
+                                        __builtin_riscv_biriscv_add16(d01_hi, d23_hi), sum);
+    sum = __builtin_riscv_biriscv_satd4(__builtin_riscv_biriscv_sub16(s01_lo, s23_lo),
+                                        __builtin_riscv_biriscv_sub16(s01_hi, s23_hi), sum);
+    sum = __builtin_riscv_biriscv_satd4(__builtin_riscv_biriscv_sub16(d01_lo, d23_lo),
+                                        __builtin_riscv_biriscv_sub16(d01_hi, d23_hi), sum);
+    return (uint32_t)sum >> 1;
+#else
+    int32_t t[4][4];
+
+    // Horizontal butterflies
+    for (int y = 0; y < 4; y++) {
+        int32_t d0 = a[y * FRAME_WIDTH + 0] - b[y * FRAME_WIDTH + 0];
+        int32_t d1 = a[y * FRAME_WIDTH + 1] - b[y * FRAME_WIDTH + 1];
+        int32_t d2 = a[y * FRAME_WIDTH + 2] - b[y * FRAME_WIDTH + 2];
+        int32_t d3 = a[y * FRAME_WIDTH + 3] - b[y * FRAME_WIDTH + 3];
+        int32_t s01 = d0 + d1, d01 = d0 - d1;
+        int32_t s23 = d2 + d3, d23 = d2 - d3;
+        t[y][0] = s01 + s23;
+        t[y][1] = d01 + d23;
+        t[y][2] = s01 - s23;
+        t[y][3] = d01 - d23;
+    }
+
+    // Vertical butterflies and magnitudes
+    uint32_t sum = 0;
+    for (int x = 0; x < 4; x++) {
+        int32_t s01 = t[0][x] + t[1][x], d01 = t[0][x] - t[1][x];
+        int32_t s23 = t[2][x] + t[3][x], d23 = t[2][x] - t[3][x];
+        int32_t v0 = s01 + s23, v1 = d01 + d23;
+        int32_t v2 = s01 - s23, v3 = d01 - d23;
+        sum += (v0 < 0 ? -v0 : v0) + (v1 < 0 ? -v1 : v1) +
+               (v2 < 0 ? -v2 : v2) + (v3 < 0 ? -v3 : v3);
+    }
+    return sum >> 1;
+#endif
+}
+
+// SATD of an 8x8 block in the frame as four 4x4 transforms
+static uint32_t block_satd_8x8(const uint8_t *cur, const uint8_t *ref) {
+    uint32_t satd = 0;
+    for (int y = 0; y < BLOCK_SIZE; y += 4) {
+        for (int x = 0; x < BLOCK_SIZE; x += 4) {
+            satd += satd_4x4(&cur[y * FRAME_WIDTH + x], &ref[y * FRAME_WIDTH + x]);
+        }
+    }
+    return satd;
+}
+
+// Mode decision: the motion-compensated block against the co-located one,
+// by SATD instead of SAD
+static uint32_t mode_decision(
+    const uint8_t *current_frame,
+    const uint8_t *reference_frame,
+    const MotionVector *motion_vectors
+) {
+    uint32_t total_cost = 0;
+
+    for (int by = 0; by < BLOCKS_Y; by++) {
+        for (int bx = 0; bx < BLOCKS_X; bx++) {
+            const MotionVector *mv = &motion_vectors[by * BLOCKS_X + bx];
+            int base_x = bx * BLOCK_SIZE;
+            int base_y = by * BLOCK_SIZE;
+            const uint8_t *cur = &current_frame[base_y * FRAME_WIDTH + base_x];
+
+            uint32_t inter = block_satd_8x8(
+                cur, &reference_frame[(base_y + mv->y) * FRAME_WIDTH + (base_x + mv->x)]);
+            uint32_t zero = block_satd_8x8(
+                cur, &reference_frame[base_y * FRAME_WIDTH + base_x]);
+            total_cost += (inter < zero) ? inter : zero;  // CSEL
+        }
+    }
+
+    return total_cost;
+}
+
 //==============================================================================
 // Test Data Generation
 //==============================================================================
@@ -449,5 +558,12 @@ uint32_t video_encoder_benchmark(void) {
     histogram_equalize(frame_temp);
     checksum += frame_temp[4000] + frame_temp[12000];
 
+    //==========================================================================
+    // PHASE 5: Mode Decision (ADD16/SUB16 + SATD4 usage)
+    //==========================================================================
+    // 256 blocks × 2 candidates × 4 SATD 4x4 = 2,048 Hadamard transforms
+
+    checksum += mode_decision(frame_current, frame_reference, motion_vectors);
+
     return checksum;
 }
@@ -1078,6 +1078,34 @@ Value *CodeGenFunction::EmitRISCVCpuIs(StringRef CPUStr) {
   return Result;
 }
 
+// The BiRiscV packed byte builtins take and return a uint8x4_t, while their
+// intrinsics work on the i32 that holds the four lanes.
+static Value *emitBiRiscVPackedByteBuiltin(CodeGenFunction *CGF,
+                                           Intrinsic::ID ID,
+                                           ArrayRef<Value *> Ops,
+                                           llvm::Type *ResultType) {
+  CGBuilderTy &Builder = CGF->Builder;
+  llvm::Type *Int32Ty = Builder.getInt32Ty();
+  Value *Packed = Builder.CreateCall(CGF->CGM.getIntrinsic(ID),
+                                     {Builder.CreateBitCast(Ops[0], Int32Ty),
+                                      Builder.CreateBitCast(Ops[1], Int32Ty)});
+  return Builder.CreateBitCast(Packed, ResultType);
+}
+
+// The immediate operands of the BiRiscV builtins are _Constant, so they are
+// constant by now, but a value that does not fit the instruction field
+// would only fail in instruction selection. Report it at the argument.
+static void checkBiRiscVImmRange(CodeGenFunction *CGF, const CallExpr *E,
+                                 ArrayRef<Value *> Ops, unsigned ArgNo,
+                                 uint64_t Max) {
+  uint64_t Imm = cast<llvm::ConstantInt>(Ops[ArgNo])->getZExtValue();
+  if (Imm > Max)
+    CGF->CGM.Error(E->getArg(ArgNo)->getExprLoc(),
+                   (Twine("argument value ") + Twine(Imm) +
+                    " is outside the valid range [0, " + Twine(Max) + "]")
+                       .str());
+}
+
 Value *CodeGenFunction::EmitRISCVBuiltinExpr(unsigned BuiltinID,
                                              const CallExpr *E,
                                              ReturnValueSlot ReturnValue) {
@@ -1364,15 +1392,90 @@ Value *CodeGenFunction::EmitRISCVBuiltinExpr(unsigned BuiltinID,
   case RISCV::BI__builtin_riscv_biriscv_madd:
     ID = Intrinsic::riscv_biriscv_madd;
     break;
+  case RISCV::BI__builtin_riscv_biriscv_dmadd16:
+    ID = Intrinsic::riscv_biriscv_dmadd16;
+    break;
+  case RISCV::BI__builtin_riscv_biriscv_dmadd16u:
+    ID = Intrinsic::riscv_biriscv_dmadd16u;
+    break;
+  case RISCV::BI__builtin_riscv_biriscv_dot4:
+    ID = Intrinsic::riscv_biriscv_dot4;
+    break;
+  case RISCV::BI__builtin_riscv_biriscv_dot4u:
+    ID = Intrinsic::riscv_biriscv_dot4u;
+    break;
+  case RISCV::BI__builtin_riscv_biriscv_dot4us:
+    ID = Intrinsic::riscv_biriscv_dot4us;
+    break;
   case RISCV::BI__builtin_riscv_biriscv_cmov:
     ID = Intrinsic::riscv_biriscv_cmov;
     break;
   case RISCV::BI__builtin_riscv_biriscv_sad:
     ID = Intrinsic::riscv_biriscv_sad;
     break;
+  case RISCV::BI__builtin_riscv_biriscv_sads:
+    ID = Intrinsic::riscv_biriscv_sads;
+    break;
+  case RISCV::BI__builtin_riscv_biriscv_sad16:
+    ID = Intrinsic::riscv_biriscv_sad16;
+    break;
+  case RISCV::BI__builtin_riscv_biriscv_add16:
+    ID = Intrinsic::riscv_biriscv_add16;
+    break;
+  case RISCV::BI__builtin_riscv_biriscv_sub16:
+    ID = Intrinsic::riscv_biriscv_sub16;
+    break;
+  case RISCV::BI__builtin_riscv_biriscv_satd4:
+    ID = Intrinsic::riscv_biriscv_satd4;
+    break;
+  case RISCV::BI__builtin_riscv_biriscv_add_b:
+    return emitBiRiscVPackedByteBuiltin(
+        this, Intrinsic::riscv_biriscv_add_b, Ops, ResultType);
+  case RISCV::BI__builtin_riscv_biriscv_sub_b:
+    return emitBiRiscVPackedByteBuiltin(
+        this, Intrinsic::riscv_biriscv_sub_b, Ops, ResultType);
+  case RISCV::BI__builtin_riscv_biriscv_addus_b:
+    return emitBiRiscVPackedByteBuiltin(
+        this, Intrinsic::riscv_biriscv_addus_b, Ops, ResultType);
+  case RISCV::BI__builtin_riscv_biriscv_subus_b:
+    return emitBiRiscVPackedByteBuiltin(
+        this, Intrinsic::riscv_biriscv_subus_b, Ops, ResultType);
+  case RISCV::BI__builtin_riscv_biriscv_avgu_b:
+    return emitBiRiscVPackedByteBuiltin(
+        this, Intrinsic::riscv_biriscv_avgu_b, Ops, ResultType);
+  case RISCV::BI__builtin_riscv_biriscv_minu_b:
+    return emitBiRiscVPackedByteBuiltin(
+        this, Intrinsic::riscv_biriscv_minu_b, Ops, ResultType);
+  case RISCV::BI__builtin_riscv_biriscv_maxu_b:
+    return emitBiRiscVPackedByteBuiltin(
+        this, Intrinsic::riscv_biriscv_maxu_b, Ops, ResultType);
   case RISCV::BI__builtin_riscv_biriscv_ternlog:
     ID = Intrinsic::riscv_biriscv_ternlog;
     break;
+  case RISCV::BI__builtin_riscv_biriscv_ternlog3:
+    checkBiRiscVImmRange(this, E, Ops, 3, 255);
+    ID = Intrinsic::riscv_biriscv_ternlog3;
+    break;
+  case RISCV::BI__builtin_riscv_biriscv_min:
+    ID = Intrinsic::riscv_biriscv_min;
+    break;
+  case RISCV::BI__builtin_riscv_biriscv_max:
+    ID = Intrinsic::riscv_biriscv_max;
+    break;
+  case RISCV::BI__builtin_riscv_biriscv_minu:
+    ID = Intrinsic::riscv_biriscv_minu;
+    break;
+  case RISCV::BI__builtin_riscv_biriscv_maxu:
+    ID = Intrinsic::riscv_biriscv_maxu;
+    break;
+  case RISCV::BI__builtin_riscv_biriscv_clip:
+    checkBiRiscVImmRange(this, E, Ops, 1, 31);
+    ID = Intrinsic::riscv_biriscv_clip;
+    break;
+  case RISCV::BI__builtin_riscv_biriscv_clipu:
+    checkBiRiscVImmRange(this, E, Ops, 1, 31);
+    ID = Intrinsic::riscv_biriscv_clipu;
+    break;
 
     // Vector builtins are handled from here.
 #include "clang/Basic/riscv_vector_builtin_cg.inc"
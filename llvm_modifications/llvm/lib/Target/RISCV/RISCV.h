@@ -15,6 +15,7 @@
 #define LLVM_LIB_TARGET_RISCV_RISCV_H
 
 #include "MCTargetDesc/RISCVBaseInfo.h"
+#include "llvm/IR/PassManager.h"
 #include "llvm/Target/TargetMachine.h"
 
 namespace llvm {
@@ -31,6 +32,27 @@ void initializeRISCVCodeGenPreparePass(PassRegistry &);
 FunctionPass *createRISCVBiRiscVPatternsPass();
 void initializeRISCVBiRiscVPatternsPass(PassRegistry &);
 
+FunctionPass *createRISCVBiRiscVEarlyIfConvertPass();
+void initializeRISCVBiRiscVEarlyIfConvertPass(PassRegistry &);
+
+FunctionPass *createRISCVBiRiscVInstrStatsPass();
+void initializeRISCVBiRiscVInstrStatsPass(PassRegistry &);
+
+FunctionPass *createRISCVBiRiscVSelectOptimizePass();
+void initializeRISCVBiRiscVSelectOptimizePass(PassRegistry &);
+
+FunctionPass *createRISCVBiRiscVSinkOperandsPass();
+void initializeRISCVBiRiscVSinkOperandsPass(PassRegistry &);
+
+class RISCVBiRiscVPatternsPass
+    : public PassInfoMixin<RISCVBiRiscVPatternsPass> {
+  const RISCVTargetMachine *TM;
+
+public:
+  RISCVBiRiscVPatternsPass(const RISCVTargetMachine &TM) : TM(&TM) {}
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &FAM);
+};
+
 FunctionPass *createRISCVDeadRegisterDefinitionsPass();
 void initializeRISCVDeadRegisterDefinitionsPass(PassRegistry &);
 
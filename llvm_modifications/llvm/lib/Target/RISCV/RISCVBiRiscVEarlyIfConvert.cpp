@@ -0,0 +1,441 @@
+//===-- RISCVBiRiscVEarlyIfConvert.cpp - If-convert into CSEL/CMOV --------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Early if-conversion for XBiRiscV. Small triangles and diamonds such as
+//
+//   if (sad < best_cost) { best_x = dx; best_y = dy; best_cost = sad; }
+//
+// are turned into straight-line code: the side blocks are speculated into
+// the head block, the branch condition is computed once into a register
+// (XOR, SLT or SLTU, or the compared register itself), and every PHI in the
+// tail block becomes one CMOV (taken if the register is non-zero) or CSEL
+// (taken if it is zero) on that register.
+//
+// SimplifyCFG only folds a few PHIs per branch, so updates of several
+// variables otherwise stay a branch that mispredicts often in search loops.
+//
+// The pass runs on SSA machine code. It converts a branch when the
+// speculated instructions plus the condition and the selects take fewer
+// issue slots than the branch is expected to cost: one cycle for the branch,
+// the misprediction penalty of the scheduling model weighted with
+// min(P, 1 - P) of the branch probability, and the instructions of the side
+// that executes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCV.h"
+#include "RISCVSubtarget.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineBranchProbabilityInfo.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineOptimizationRemarkEmitter.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/CodeGen/TargetInstrInfo.h"
+#include "llvm/CodeGen/TargetSchedule.h"
+#include "llvm/Support/CommandLine.h"
+
+using namespace llvm;
+
+// Statistics and remarks share the name of RISCVBiRiscVPatterns
+#define DEBUG_TYPE "riscv-biriscv-patterns"
+#define RISCV_BIRISCV_EARLY_IFCVT_NAME "RISC-V BiRiscV early if-conversion"
+
+STATISTIC(NumTrianglesConverted, "Number of triangles if-converted");
+STATISTIC(NumDiamondsConverted, "Number of diamonds if-converted");
+STATISTIC(NumIfCvtSelects, "Number of CSEL/CMOV inserted by if-conversion");
+
+static cl::opt<unsigned> IfCvtMaxInstrs(
+    "riscv-biriscv-ifcvt-max-instrs", cl::Hidden, cl::init(8),
+    cl::desc("Maximum number of instructions speculated by XBiRiscV early "
+             "if-conversion"));
+
+namespace {
+
+// A branch and the blocks it if-converts. For a triangle one of TrueBB and
+// FalseBB is the tail itself.
+struct IfCvtCandidate {
+  MachineBasicBlock *Head = nullptr;
+  MachineBasicBlock *Tail = nullptr;
+  // Where the branch goes when taken and when not
+  MachineBasicBlock *TrueBB = nullptr;
+  MachineBasicBlock *FalseBB = nullptr;
+  MachineInstr *Branch = nullptr;
+
+  bool isSide(const MachineBasicBlock *MBB) const {
+    return MBB != Tail && (MBB == TrueBB || MBB == FalseBB);
+  }
+};
+
+class RISCVBiRiscVEarlyIfConvert : public MachineFunctionPass {
+public:
+  static char ID;
+
+  RISCVBiRiscVEarlyIfConvert() : MachineFunctionPass(ID) {}
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<MachineBranchProbabilityInfoWrapperPass>();
+    AU.addRequired<MachineOptimizationRemarkEmitterPass>();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  StringRef getPassName() const override {
+    return RISCV_BIRISCV_EARLY_IFCVT_NAME;
+  }
+
+private:
+  const TargetInstrInfo *TII = nullptr;
+  MachineRegisterInfo *MRI = nullptr;
+  const MachineBranchProbabilityInfo *MBPI = nullptr;
+  MachineOptimizationRemarkEmitter *ORE = nullptr;
+  TargetSchedModel SchedModel;
+
+  bool canSpeculate(const MachineBasicBlock &Side,
+                    const MachineBasicBlock &Tail, unsigned &NumInstrs) const;
+  bool findCandidate(MachineBasicBlock &Head, IfCvtCandidate &C) const;
+  bool isProfitable(const IfCvtCandidate &C, unsigned NumSelects) const;
+  Register materializeCondition(const IfCvtCandidate &C, bool &TakenIfZero);
+  void convert(IfCvtCandidate &C);
+};
+
+} // end anonymous namespace
+
+char RISCVBiRiscVEarlyIfConvert::ID = 0;
+
+INITIALIZE_PASS_BEGIN(RISCVBiRiscVEarlyIfConvert, "riscv-biriscv-early-ifcvt",
+                      RISCV_BIRISCV_EARLY_IFCVT_NAME, false, false)
+INITIALIZE_PASS_DEPENDENCY(MachineBranchProbabilityInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(MachineOptimizationRemarkEmitterPass)
+INITIALIZE_PASS_END(RISCVBiRiscVEarlyIfConvert, "riscv-biriscv-early-ifcvt",
+                    RISCV_BIRISCV_EARLY_IFCVT_NAME, false, false)
+
+static bool isCondBranch(const MachineInstr &MI) {
+  switch (MI.getOpcode()) {
+  case RISCV::BEQ:
+  case RISCV::BNE:
+  case RISCV::BLT:
+  case RISCV::BGE:
+  case RISCV::BLTU:
+  case RISCV::BGEU:
+    return true;
+  }
+  return false;
+}
+
+// Side is a block with Head as its only predecessor that falls through or
+// jumps to Tail, and whose instructions can all execute unconditionally.
+bool RISCVBiRiscVEarlyIfConvert::canSpeculate(const MachineBasicBlock &Side,
+                                              const MachineBasicBlock &Tail,
+                                              unsigned &NumInstrs) const {
+  if (Side.pred_size() != 1 || Side.succ_size() != 1 ||
+      *Side.succ_begin() != &Tail || Side.isEHPad() ||
+      Side.hasAddressTaken())
+    return false;
+
+  NumInstrs = 0;
+  for (const MachineInstr &MI : Side) {
+    if (MI.isDebugInstr())
+      continue;
+    if (MI.isTerminator()) {
+      if (MI.getOpcode() != RISCV::PseudoBR)
+        return false;
+      continue;
+    }
+    bool SawStore = false;
+    if (MI.isPHI() || MI.mayLoadOrStore() || MI.isCall() ||
+        MI.hasUnmodeledSideEffects() || !MI.isSafeToMove(SawStore))
+      return false;
+    // Only virtual registers (and x0), so nothing is clobbered on the other
+    // path
+    for (const MachineOperand &MO : MI.operands())
+      if (MO.isReg() && MO.getReg().isPhysical() && MO.getReg() != RISCV::X0)
+        return false;
+    if (++NumInstrs > IfCvtMaxInstrs)
+      return false;
+  }
+  return true;
+}
+
+bool RISCVBiRiscVEarlyIfConvert::findCandidate(MachineBasicBlock &Head,
+                                               IfCvtCandidate &C) const {
+  if (Head.succ_size() != 2)
+    return false;
+
+  // A conditional branch, optionally followed by a jump
+  auto FirstTerm = Head.getFirstTerminator();
+  if (FirstTerm == Head.end() || !isCondBranch(*FirstTerm))
+    return false;
+  C.Head = &Head;
+  C.Branch = &*FirstTerm;
+  C.TrueBB = C.Branch->getOperand(2).getMBB();
+  C.FalseBB = *Head.succ_begin() == C.TrueBB ? *std::next(Head.succ_begin())
+                                              : *Head.succ_begin();
+  if (C.TrueBB == C.FalseBB || C.TrueBB == &Head || C.FalseBB == &Head)
+    return false;
+
+  // Triangle: one successor is the tail, the other a side block that joins
+  // it. Diamond: both successors are side blocks with the same successor.
+  unsigned NumTrue = 0, NumFalse = 0;
+  if (C.TrueBB->succ_size() == 1 && *C.TrueBB->succ_begin() == C.FalseBB)
+    C.Tail = C.FalseBB;
+  else if (C.FalseBB->succ_size() == 1 && *C.FalseBB->succ_begin() == C.TrueBB)
+    C.Tail = C.TrueBB;
+  else if (C.TrueBB->succ_size() == 1 && C.FalseBB->succ_size() == 1 &&
+           *C.TrueBB->succ_begin() == *C.FalseBB->succ_begin())
+    C.Tail = *C.TrueBB->succ_begin();
+  else
+    return false;
+
+  // The tail must only be reached through the if, so its PHIs can go away
+  if (C.Tail == &Head || C.Tail->pred_size() != 2 || C.Tail->isEHPad() ||
+      C.Tail->hasAddressTaken())
+    return false;
+  if (C.isSide(C.TrueBB) && !canSpeculate(*C.TrueBB, *C.Tail, NumTrue))
+    return false;
+  if (C.isSide(C.FalseBB) && !canSpeculate(*C.FalseBB, *C.Tail, NumFalse))
+    return false;
+  if (NumTrue + NumFalse > IfCvtMaxInstrs)
+    return false;
+
+  // Every live-out becomes a GPR select
+  for (const MachineInstr &PHI : C.Tail->phis())
+    if (!RISCV::GPRRegClass.hasSubClassEq(
+            MRI->getRegClass(PHI.getOperand(0).getReg())))
+      return false;
+  return true;
+}
+
+static unsigned countInstrs(const MachineBasicBlock &MBB) {
+  unsigned N = 0;
+  for (const MachineInstr &MI : MBB)
+    if (!MI.isDebugInstr() && !MI.isTerminator())
+      ++N;
+  return N;
+}
+
+// Costs are in issue slots, IssueWidth to a cycle
+bool RISCVBiRiscVEarlyIfConvert::isProfitable(const IfCvtCandidate &C,
+                                              unsigned NumSelects) const {
+  const MCSchedModel *SM = SchedModel.getMCSchedModel();
+  unsigned IssueWidth = SchedModel.getIssueWidth();
+  unsigned NumTrue = C.isSide(C.TrueBB) ? countInstrs(*C.TrueBB) : 0;
+  unsigned NumFalse = C.isSide(C.FalseBB) ? countInstrs(*C.FalseBB) : 0;
+
+  // The selects also wait for the slowest speculated instruction (e.g. a
+  // multiply) instead of issuing right behind it
+  unsigned MaxLatency = 1;
+  for (MachineBasicBlock *Side : {C.TrueBB, C.FalseBB})
+    if (C.isSide(Side))
+      for (const MachineInstr &MI : *Side)
+        if (!MI.isDebugInstr() && !MI.isTerminator())
+          MaxLatency =
+              std::max(MaxLatency, SchedModel.computeInstrLatency(&MI));
+
+  // The condition register costs one instruction unless the branch tests a
+  // register against zero
+  unsigned CondCost = 1;
+  if ((C.Branch->getOpcode() == RISCV::BEQ ||
+       C.Branch->getOpcode() == RISCV::BNE) &&
+      (C.Branch->getOperand(0).getReg() == RISCV::X0 ||
+       C.Branch->getOperand(1).getReg() == RISCV::X0))
+    CondCost = 0;
+  uint64_t ConvertedCost = NumTrue + NumFalse + CondCost + NumSelects +
+                           IssueWidth * (MaxLatency - 1);
+
+  BranchProbability TrueProb = MBPI->getEdgeProbability(C.Head, C.TrueBB);
+  BranchProbability MispredictProb = std::min(TrueProb, TrueProb.getCompl());
+  uint64_t BranchCost =
+      IssueWidth + MispredictProb.scale(IssueWidth * SM->MispredictPenalty) +
+      TrueProb.scale(NumTrue) + TrueProb.getCompl().scale(NumFalse);
+
+  bool Profitable = ConvertedCost <= BranchCost;
+  ORE->emit([&]() {
+    return MachineOptimizationRemarkAnalysis(
+               DEBUG_TYPE, Profitable ? "IfCvtCost" : "IfCvtNotProfitable",
+               C.Branch->getDebugLoc(), C.Head)
+           << "if-converted cost " << ore::NV("ConvertedCost", ConvertedCost)
+           << " vs branch cost " << ore::NV("BranchCost", BranchCost)
+           << " issue slots";
+  });
+  return Profitable;
+}
+
+// Compute the branch condition into one register. TakenIfZero tells whether
+// the branch is taken when that register is zero (CSEL) or non-zero (CMOV).
+Register
+RISCVBiRiscVEarlyIfConvert::materializeCondition(const IfCvtCandidate &C,
+                                                 bool &TakenIfZero) {
+  MachineBasicBlock &Head = *C.Head;
+  MachineInstr &Br = *C.Branch;
+  const DebugLoc &DL = Br.getDebugLoc();
+  Register LHS = Br.getOperand(0).getReg();
+  Register RHS = Br.getOperand(1).getReg();
+
+  unsigned Opc;
+  switch (Br.getOpcode()) {
+  case RISCV::BEQ:
+  case RISCV::BNE:
+    TakenIfZero = Br.getOpcode() == RISCV::BEQ;
+    if (RHS == RISCV::X0 && LHS.isVirtual())
+      return LHS;
+    if (LHS == RISCV::X0 && RHS.isVirtual())
+      return RHS;
+    Opc = RISCV::XOR;
+    break;
+  case RISCV::BLT:
+  case RISCV::BGE:
+    TakenIfZero = Br.getOpcode() == RISCV::BGE;
+    Opc = RISCV::SLT;
+    break;
+  default:
+    TakenIfZero = Br.getOpcode() == RISCV::BGEU;
+    Opc = RISCV::SLTU;
+    break;
+  }
+
+  Register CondReg = MRI->createVirtualRegister(&RISCV::GPRRegClass);
+  BuildMI(Head, Br, DL, TII->get(Opc), CondReg)
+      .addReg(LHS)
+      .addReg(RHS);
+  return CondReg;
+}
+
+void RISCVBiRiscVEarlyIfConvert::convert(IfCvtCandidate &C) {
+  MachineBasicBlock &Head = *C.Head;
+  MachineBasicBlock &Tail = *C.Tail;
+  MachineInstr &Br = *C.Branch;
+  const DebugLoc DL = Br.getDebugLoc();
+  bool IsDiamond = C.isSide(C.TrueBB) && C.isSide(C.FalseBB);
+
+  // Speculate the side blocks in front of the branch
+  for (MachineBasicBlock *Side : {C.TrueBB, C.FalseBB}) {
+    if (!C.isSide(Side))
+      continue;
+    for (MachineInstr &MI :
+         make_early_inc_range(make_range(Side->begin(),
+                                         Side->getFirstTerminator()))) {
+      for (const MachineOperand &MO : MI.uses())
+        if (MO.isReg() && MO.getReg().isVirtual())
+          MRI->clearKillFlags(MO.getReg());
+      Head.splice(Br.getIterator(), Side, MI.getIterator());
+    }
+  }
+
+  bool TakenIfZero;
+  Register CondReg = materializeCondition(C, TakenIfZero);
+  MRI->clearKillFlags(CondReg);
+
+  // The value each PHI takes on the taken and the not-taken path
+  MachineBasicBlock *TruePred = C.TrueBB == &Tail ? &Head : C.TrueBB;
+  MachineBasicBlock *FalsePred = C.FalseBB == &Tail ? &Head : C.FalseBB;
+  for (MachineInstr &PHI : make_early_inc_range(Tail.phis())) {
+    Register TrueVal, FalseVal;
+    for (unsigned I = 1, E = PHI.getNumOperands(); I != E; I += 2) {
+      if (PHI.getOperand(I + 1).getMBB() == TruePred)
+        TrueVal = PHI.getOperand(I).getReg();
+      else if (PHI.getOperand(I + 1).getMBB() == FalsePred)
+        FalseVal = PHI.getOperand(I).getReg();
+    }
+    Register DstReg = PHI.getOperand(0).getReg();
+    MRI->clearKillFlags(TrueVal);
+    MRI->clearKillFlags(FalseVal);
+
+    if (TrueVal == FalseVal) {
+      BuildMI(Head, Br, DL, TII->get(TargetOpcode::COPY), DstReg)
+          .addReg(TrueVal);
+    } else {
+      BuildMI(Head, Br, DL, TII->get(TakenIfZero ? RISCV::CSEL : RISCV::CMOV),
+              DstReg)
+          .addReg(TrueVal)
+          .addReg(FalseVal)
+          .addReg(CondReg);
+      ++NumIfCvtSelects;
+    }
+    PHI.eraseFromParent();
+  }
+
+  // Head now runs straight into the tail
+  TII->removeBranch(Head);
+  for (MachineBasicBlock *Side : {C.TrueBB, C.FalseBB}) {
+    if (!C.isSide(Side))
+      continue;
+    Head.removeSuccessor(Side);
+    Side->removeSuccessor(&Tail);
+    Side->eraseFromParent();
+  }
+  if (!Head.isSuccessor(&Tail))
+    Head.addSuccessor(&Tail);
+  Head.normalizeSuccProbs();
+
+  // Tail has no other predecessors, so it can be merged into the head if it
+  // follows it
+  if (Head.isLayoutSuccessor(&Tail)) {
+    Head.splice(Head.end(), &Tail, Tail.begin(), Tail.end());
+    Head.removeSuccessor(&Tail);
+    Head.transferSuccessorsAndUpdatePHIs(&Tail);
+    Tail.eraseFromParent();
+  } else {
+    TII->insertUnconditionalBranch(Head, &Tail, DL);
+  }
+
+  if (IsDiamond)
+    ++NumDiamondsConverted;
+  else
+    ++NumTrianglesConverted;
+}
+
+bool RISCVBiRiscVEarlyIfConvert::runOnMachineFunction(MachineFunction &MF) {
+  if (skipFunction(MF.getFunction()))
+    return false;
+
+  const auto &ST = MF.getSubtarget<RISCVSubtarget>();
+  if (!ST.hasStdExtXBiRiscV())
+    return false;
+
+  TII = ST.getInstrInfo();
+  MRI = &MF.getRegInfo();
+  MBPI = &getAnalysis<MachineBranchProbabilityInfoWrapperPass>().getMBPI();
+  ORE = &getAnalysis<MachineOptimizationRemarkEmitterPass>().getORE();
+  SchedModel.init(&ST);
+
+  // Visit the blocks in post-order, so that an inner if is converted before
+  // the one around it. Converting a head only erases blocks that come
+  // before it in this order.
+  SmallVector<MachineBasicBlock *, 16> Blocks;
+  for (MachineBasicBlock *MBB : post_order(&MF))
+    Blocks.push_back(MBB);
+
+  bool MadeChange = false;
+  for (MachineBasicBlock *MBB : Blocks) {
+    IfCvtCandidate C;
+    if (!findCandidate(*MBB, C))
+      continue;
+
+    unsigned NumSelects = range_size(C.Tail->phis());
+    if (!isProfitable(C, NumSelects))
+      continue;
+
+    ORE->emit([&]() {
+      return MachineOptimizationRemark(DEBUG_TYPE, "IfConverted",
+                                       C.Branch->getDebugLoc(), C.Head)
+             << "if-converted branch into "
+             << ore::NV("NumSelects", NumSelects) << " CSEL/CMOV";
+    });
+    convert(C);
+    MadeChange = true;
+  }
+
+  return MadeChange;
+}
+
+FunctionPass *llvm::createRISCVBiRiscVEarlyIfConvertPass() {
+  return new RISCVBiRiscVEarlyIfConvert();
+}
@@ -0,0 +1,221 @@
+//===-- RISCVBiRiscVHazardRecognizer.cpp - biriscv dual-issue hazards -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// biriscv fetches 8-byte groups and issues up to two instructions per cycle,
+// slot A from the first word and slot B from the second. The issue stage
+// (biriscv_issue.v) only pairs them when:
+//
+//   - slot A is an ALU, load/store or multiply instruction, and slot B is an
+//     ALU, load/store, multiply or branch instruction,
+//   - they do not both need the LSU or both need the multiplier,
+//   - slot B does not read or write the destination of slot A,
+//   - the group started at the first word of the fetch group.
+//
+// In addition a multiply, divide or CSR access cannot issue in slot A in the
+// cycle after a load or store.
+//
+// The hazard recognizer reports an instruction as a hazard whenever the
+// issue stage would hold it back to the next cycle, so the post-RA
+// scheduler looks for another instruction to fill the second slot.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCVBiRiscVHazardRecognizer.h"
+#include "RISCVSubtarget.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/CodeGen/ScheduleDAG.h"
+#include "llvm/CodeGen/TargetInstrInfo.h"
+#include "llvm/CodeGen/TargetRegisterInfo.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "riscv-biriscv-hazard"
+
+RISCVBiRiscVHazardRecognizer::RISCVBiRiscVHazardRecognizer(
+    const TargetInstrInfo *TII, const TargetRegisterInfo *TRI)
+    : TII(TII), TRI(TRI) {
+  MaxLookAhead = 1;
+}
+
+RISCVBiRiscVHazardRecognizer::IssueClass
+RISCVBiRiscVHazardRecognizer::getIssueClass(const MachineInstr &MI) {
+  if (MI.isCall() || MI.isBranch() || MI.isReturn() ||
+      MI.getOpcode() == RISCV::JAL || MI.getOpcode() == RISCV::JALR)
+    return Branch;
+
+  switch (MI.getOpcode()) {
+  case RISCV::MUL:
+  case RISCV::MULH:
+  case RISCV::MULHSU:
+  case RISCV::MULHU:
+  case RISCV::MADD:
+  case RISCV::DMADD16:
+  case RISCV::DMADD16U:
+  case RISCV::DOT4:
+  case RISCV::DOT4U:
+  case RISCV::DOT4US:
+    return Mul;
+  case RISCV::DIV:
+  case RISCV::DIVU:
+  case RISCV::REM:
+  case RISCV::REMU:
+    return Div;
+  }
+
+  if (MI.mayLoadOrStore())
+    return LSU;
+  // CSR accesses, fences, ecall/ebreak and inline asm
+  if (MI.hasUnmodeledSideEffects())
+    return CSR;
+  return Exec;
+}
+
+bool RISCVBiRiscVHazardRecognizer::canPair(const MachineInstr &A,
+                                           const MachineInstr &B) const {
+  IssueClass ClassA = getIssueClass(A);
+  IssueClass ClassB = getIssueClass(B);
+
+  if (ClassA != Exec && ClassA != LSU && ClassA != Mul)
+    return false;
+
+  switch (ClassB) {
+  case Exec:
+  case Branch:
+    break;
+  case LSU:
+    if (ClassA == LSU)
+      return false;
+    break;
+  case Mul:
+    if (ClassA == Mul)
+      return false;
+    break;
+  default:
+    // Divides and CSR accesses only issue in pipe 0
+    return false;
+  }
+
+  // The scoreboard entry for slot A's destination is set before slot B is
+  // checked, so B cannot read or overwrite it
+  for (const MachineOperand &Def : A.defs()) {
+    if (!Def.getReg() || Def.getReg() == RISCV::X0)
+      continue;
+    for (const MachineOperand &MO : B.operands())
+      if (MO.isReg() && MO.getReg() &&
+          TRI->regsOverlap(MO.getReg(), Def.getReg()))
+        return false;
+  }
+
+  return true;
+}
+
+void RISCVBiRiscVHazardRecognizer::enterRegion(
+    std::optional<unsigned> Offset) {
+  Reset();
+  OffsetKnown = Offset.has_value();
+  FetchOffset = Offset.value_or(0);
+}
+
+ScheduleHazardRecognizer::HazardType
+RISCVBiRiscVHazardRecognizer::getHazardType(SUnit *SU, int Stalls) {
+  const MachineInstr *MI = SU->getInstr();
+  if (!MI || MI->isMetaInstruction())
+    return NoHazard;
+
+  if (Group.empty()) {
+    if (PrevCycleMemOp) {
+      IssueClass Class = getIssueClass(*MI);
+      if (Class == Mul || Class == Div || Class == CSR)
+        return Hazard;
+    }
+    return NoHazard;
+  }
+
+  // Pseudos that expand to several instructions issue on their own
+  if (Group.size() > 1 || TII->getInstSizeInBytes(*Group.front()) != 4 ||
+      TII->getInstSizeInBytes(*MI) != 4)
+    return Hazard;
+
+  // The second word of a fetch group always issues alone in slot A
+  if (OffsetKnown && GroupOffset != 0)
+    return Hazard;
+
+  return canPair(*Group.front(), *MI) ? NoHazard : Hazard;
+}
+
+void RISCVBiRiscVHazardRecognizer::EmitInstruction(SUnit *SU) {
+  const MachineInstr *MI = SU->getInstr();
+  if (!MI || MI->isMetaInstruction())
+    return;
+
+  if (Group.empty())
+    GroupOffset = FetchOffset;
+  Group.push_back(MI);
+  FetchOffset = (FetchOffset + TII->getInstSizeInBytes(*MI)) % 8;
+}
+
+void RISCVBiRiscVHazardRecognizer::AdvanceCycle() {
+  PrevCycleMemOp = any_of(Group, [](const MachineInstr *MI) {
+    return getIssueClass(*MI) == LSU;
+  });
+  Group.clear();
+}
+
+void RISCVBiRiscVHazardRecognizer::Reset() {
+  Group.clear();
+  PrevCycleMemOp = false;
+}
+
+void RISCVBiRiscVPostRASchedStrategy::initPolicy(
+    MachineBasicBlock::iterator Begin, MachineBasicBlock::iterator End,
+    unsigned NumRegionInstrs) {
+  PostGenericScheduler::initPolicy(Begin, End, NumRegionInstrs);
+
+  // The hazard recognizer models issue cycles in program order
+  RegionPolicy.OnlyTopDown = true;
+  RegionPolicy.OnlyBottomUp = false;
+
+  // The fetch group position is only known if the block starts on an 8-byte
+  // boundary and every instruction is 4 bytes long. Block alignments are
+  // only assigned by block placement, after this scheduler, so they are
+  // predicted: the entry block starts at the function alignment and a loop
+  // header at the preferred loop alignment, which placement normally gives
+  // the top of a hot loop. Other blocks start at an unknown offset.
+  RegionOffset.reset();
+  MachineBasicBlock *MBB = Begin->getParent();
+  const MachineFunction &MF = *MBB->getParent();
+  const auto &ST = MF.getSubtarget<RISCVSubtarget>();
+  Align BlockAlign = MBB->getAlignment();
+  if (MBB->isEntryBlock())
+    BlockAlign = std::max(BlockAlign, MF.getAlignment());
+  else if (MachineLoop *L = Context->MLI ? Context->MLI->getLoopFor(MBB)
+                                         : nullptr;
+           L && L->getHeader() == MBB)
+    BlockAlign = std::max(BlockAlign,
+                          ST.getTargetLowering()->getPrefLoopAlignment(L));
+  if (BlockAlign < Align(8) || ST.hasStdExtZca())
+    return;
+
+  unsigned Offset = 0;
+  for (const MachineInstr &MI : make_range(MBB->begin(), Begin))
+    Offset += ST.getInstrInfo()->getInstSizeInBytes(MI);
+  RegionOffset = Offset % 8;
+}
+
+void RISCVBiRiscVPostRASchedStrategy::initialize(ScheduleDAGMI *Dag) {
+  // PostGenericScheduler only creates the default recognizer if there is
+  // none yet
+  if (!BiRiscVHazardRec) {
+    BiRiscVHazardRec = new RISCVBiRiscVHazardRecognizer(Dag->TII, Dag->TRI);
+    Top.HazardRec = BiRiscVHazardRec;
+  }
+
+  PostGenericScheduler::initialize(Dag);
+  BiRiscVHazardRec->enterRegion(RegionOffset);
+}
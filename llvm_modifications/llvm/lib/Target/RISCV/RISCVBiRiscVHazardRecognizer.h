@@ -0,0 +1,88 @@
+//===-- RISCVBiRiscVHazardRecognizer.h - biriscv issue hazards -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Hazard recognizer and post-RA scheduling strategy that model the pairing
+// rules of the biriscv issue stage (biriscv_issue.v), so that the post-RA
+// scheduler places instructions that can dual-issue next to each other.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_RISCV_RISCVBIRISCVHAZARDRECOGNIZER_H
+#define LLVM_LIB_TARGET_RISCV_RISCVBIRISCVHAZARDRECOGNIZER_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/CodeGen/MachineScheduler.h"
+#include "llvm/CodeGen/ScheduleHazardRecognizer.h"
+#include <optional>
+
+namespace llvm {
+
+class MachineInstr;
+class TargetInstrInfo;
+class TargetRegisterInfo;
+
+// Top-down model of one biriscv issue cycle. An instruction is a hazard if
+// the issue stage would not accept it in the same cycle as the instructions
+// already placed there.
+class RISCVBiRiscVHazardRecognizer : public ScheduleHazardRecognizer {
+public:
+  // Execution unit classes as seen by the issue stage (biriscv_decoder.v)
+  enum IssueClass { Exec, LSU, Branch, Mul, Div, CSR };
+
+private:
+  const TargetInstrInfo *TII;
+  const TargetRegisterInfo *TRI;
+
+  // Instructions issued in the current cycle (slot A, then slot B)
+  SmallVector<const MachineInstr *, 2> Group;
+  // The previous cycle issued a load or store
+  bool PrevCycleMemOp = false;
+  // Byte offset of the next instruction within its 8-byte fetch group, if
+  // it is known
+  bool OffsetKnown = false;
+  unsigned FetchOffset = 0;
+  // Offset of the instruction in slot A
+  unsigned GroupOffset = 0;
+
+  bool canPair(const MachineInstr &A, const MachineInstr &B) const;
+
+public:
+  RISCVBiRiscVHazardRecognizer(const TargetInstrInfo *TII,
+                               const TargetRegisterInfo *TRI);
+
+  static IssueClass getIssueClass(const MachineInstr &MI);
+
+  // Start a scheduling region whose first instruction is Offset bytes into
+  // an 8-byte fetch group (or at an unknown offset).
+  void enterRegion(std::optional<unsigned> Offset);
+
+  HazardType getHazardType(SUnit *SU, int Stalls) override;
+  void EmitInstruction(SUnit *SU) override;
+  void AdvanceCycle() override;
+  void Reset() override;
+};
+
+// PostGenericScheduler with the biriscv hazard recognizer on its top-down
+// boundary.
+class RISCVBiRiscVPostRASchedStrategy : public PostGenericScheduler {
+  RISCVBiRiscVHazardRecognizer *BiRiscVHazardRec = nullptr;
+  std::optional<unsigned> RegionOffset;
+
+public:
+  RISCVBiRiscVPostRASchedStrategy(const MachineSchedContext *C)
+      : PostGenericScheduler(C) {}
+
+  void initPolicy(MachineBasicBlock::iterator Begin,
+                  MachineBasicBlock::iterator End,
+                  unsigned NumRegionInstrs) override;
+  void initialize(ScheduleDAGMI *Dag) override;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_LIB_TARGET_RISCV_RISCVBIRISCVHAZARDRECOGNIZER_H
@@ -0,0 +1,211 @@
+//===-- RISCVBiRiscVInstrStats.cpp - BiRiscV instruction statistics -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass counts the XBiRiscV instructions left after instruction
+// selection, including the ones formed by the TableGen patterns in
+// RISCVInstrInfoBiRiscV.td (MADD, CSEL, CMOV, BREV), and emits an
+// optimization remark for each of them. It also reports MUL/ADD pairs that
+// were not fused into a MADD.
+//
+// Statistics and remarks use the same name as RISCVBiRiscVPatterns, so
+//   -Rpass=riscv-biriscv-patterns -Rpass-missed=riscv-biriscv-patterns
+// and -stats cover the IR and the machine level together.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCV.h"
+#include "RISCVSubtarget.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineOptimizationRemarkEmitter.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/CodeGen/TargetInstrInfo.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "riscv-biriscv-patterns"
+#define RISCV_BIRISCV_INSTR_STATS_NAME "RISC-V BiRiscV instruction statistics"
+
+STATISTIC(NumBREV, "Number of BREV instructions selected");
+STATISTIC(NumCSEL, "Number of CSEL instructions selected");
+STATISTIC(NumCMOV, "Number of CMOV instructions selected");
+STATISTIC(NumMADD, "Number of MADD instructions selected");
+STATISTIC(NumDMADD16, "Number of DMADD16/DMADD16U instructions selected");
+STATISTIC(NumDOT4, "Number of DOT4/DOT4U/DOT4US instructions selected");
+STATISTIC(NumSAD, "Number of SAD instructions selected");
+STATISTIC(NumSADS, "Number of SADS instructions selected");
+STATISTIC(NumSAD16, "Number of SAD16 instructions selected");
+STATISTIC(NumADDSUB16, "Number of ADD16/SUB16 instructions selected");
+STATISTIC(NumSATD4, "Number of SATD4 instructions selected");
+STATISTIC(NumPackedByte,
+          "Number of packed byte (ADD.B ... MAXU.B) instructions selected");
+STATISTIC(NumTERNLOG, "Number of TERNLOG instructions selected");
+STATISTIC(NumTERNLOG3, "Number of TERNLOG3 instructions selected");
+STATISTIC(NumMINMAX, "Number of MIN/MAX/MINU/MAXU instructions selected");
+STATISTIC(NumCLIP, "Number of CLIP/CLIPU instructions selected");
+STATISTIC(NumMADDMissed, "Number of MUL/ADD pairs not fused into MADD");
+
+namespace {
+
+class RISCVBiRiscVInstrStats : public MachineFunctionPass {
+public:
+  static char ID;
+
+  RISCVBiRiscVInstrStats() : MachineFunctionPass(ID) {}
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.setPreservesAll();
+    AU.addRequired<MachineOptimizationRemarkEmitterPass>();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  StringRef getPassName() const override {
+    return RISCV_BIRISCV_INSTR_STATS_NAME;
+  }
+
+private:
+  void reportUnfusedMul(const MachineInstr &Mul,
+                        const MachineRegisterInfo &MRI,
+                        MachineOptimizationRemarkEmitter &ORE);
+};
+
+} // end anonymous namespace
+
+char RISCVBiRiscVInstrStats::ID = 0;
+
+INITIALIZE_PASS_BEGIN(RISCVBiRiscVInstrStats, "riscv-biriscv-instr-stats",
+                      RISCV_BIRISCV_INSTR_STATS_NAME, false, true)
+INITIALIZE_PASS_DEPENDENCY(MachineOptimizationRemarkEmitterPass)
+INITIALIZE_PASS_END(RISCVBiRiscVInstrStats, "riscv-biriscv-instr-stats",
+                    RISCV_BIRISCV_INSTR_STATS_NAME, false, true)
+
+// A MUL whose product is added to something would have been a MADD if the
+// product had no other users.
+void RISCVBiRiscVInstrStats::reportUnfusedMul(
+    const MachineInstr &Mul, const MachineRegisterInfo &MRI,
+    MachineOptimizationRemarkEmitter &ORE) {
+  Register Product = Mul.getOperand(0).getReg();
+  if (!Product.isVirtual() || MRI.hasOneNonDBGUse(Product))
+    return;
+
+  unsigned NumUses =
+      std::distance(MRI.use_nodbg_begin(Product), MRI.use_nodbg_end());
+  for (const MachineInstr &UseMI : MRI.use_nodbg_instructions(Product)) {
+    if (UseMI.getOpcode() != RISCV::ADD)
+      continue;
+    ++NumMADDMissed;
+    ORE.emit([&]() {
+      return MachineOptimizationRemarkMissed(DEBUG_TYPE, "MADDNotFormed",
+                                             UseMI.getDebugLoc(),
+                                             UseMI.getParent())
+             << "MUL/ADD not fused into MADD: product has "
+             << ore::NV("NumUses", NumUses) << " uses";
+    });
+    return;
+  }
+}
+
+bool RISCVBiRiscVInstrStats::runOnMachineFunction(MachineFunction &MF) {
+  const auto &ST = MF.getSubtarget<RISCVSubtarget>();
+  if (!ST.hasStdExtXBiRiscV())
+    return false;
+
+  const TargetInstrInfo *TII = ST.getInstrInfo();
+  const MachineRegisterInfo &MRI = MF.getRegInfo();
+  auto &ORE = getAnalysis<MachineOptimizationRemarkEmitterPass>().getORE();
+
+  for (MachineBasicBlock &MBB : MF) {
+    for (MachineInstr &MI : MBB) {
+      switch (MI.getOpcode()) {
+      case RISCV::BREV:
+        ++NumBREV;
+        break;
+      case RISCV::CSEL:
+        ++NumCSEL;
+        break;
+      case RISCV::CMOV:
+        ++NumCMOV;
+        break;
+      case RISCV::MADD:
+        ++NumMADD;
+        break;
+      case RISCV::DMADD16:
+      case RISCV::DMADD16U:
+        ++NumDMADD16;
+        break;
+      case RISCV::DOT4:
+      case RISCV::DOT4U:
+      case RISCV::DOT4US:
+        ++NumDOT4;
+        break;
+      case RISCV::SAD:
+        ++NumSAD;
+        break;
+      case RISCV::SADS:
+        ++NumSADS;
+        break;
+      case RISCV::SAD16:
+        ++NumSAD16;
+        break;
+      case RISCV::BIRISCV_ADD16:
+      case RISCV::BIRISCV_SUB16:
+        ++NumADDSUB16;
+        break;
+      case RISCV::SATD4:
+        ++NumSATD4;
+        break;
+      case RISCV::BIRISCV_ADD_B:
+      case RISCV::BIRISCV_SUB_B:
+      case RISCV::BIRISCV_ADDUS_B:
+      case RISCV::BIRISCV_SUBUS_B:
+      case RISCV::BIRISCV_AVGU_B:
+      case RISCV::BIRISCV_MINU_B:
+      case RISCV::BIRISCV_MAXU_B:
+        ++NumPackedByte;
+        break;
+      case RISCV::TERNLOG:
+        ++NumTERNLOG;
+        break;
+      case RISCV::TERNLOG3:
+        ++NumTERNLOG3;
+        break;
+      case RISCV::BIRISCV_MIN:
+      case RISCV::BIRISCV_MAX:
+      case RISCV::BIRISCV_MINU:
+      case RISCV::BIRISCV_MAXU:
+        ++NumMINMAX;
+        break;
+      case RISCV::CLIP:
+      case RISCV::CLIPU:
+        ++NumCLIP;
+        break;
+      case RISCV::MUL:
+        if (MRI.isSSA())
+          reportUnfusedMul(MI, MRI, ORE);
+        continue;
+      default:
+        continue;
+      }
+
+      ORE.emit([&]() {
+        return MachineOptimizationRemark(DEBUG_TYPE, "Selected",
+                                         MI.getDebugLoc(), &MBB)
+               << "selected "
+               << ore::NV("Instruction", TII->getName(MI.getOpcode()));
+      });
+    }
+  }
+
+  return false;
+}
+
+FunctionPass *llvm::createRISCVBiRiscVInstrStatsPass() {
+  return new RISCVBiRiscVInstrStats();
+}
@@ -19,33 +19,270 @@
 //   acc += abs((int8_t)(a >> 16) - (int8_t)(b >> 16));
 //   acc += abs((int8_t)(a >> 24) - (int8_t)(b >> 24));
 //
-// And replaces them with a single SAD instruction call.
+// And replaces them with a single SAD instruction call. The bytes above are
+// sign-extended, so this example becomes SADS, the signed-byte variant;
+// zero-extended bytes (`(uint8_t)(a >> 8)`, `a & 0xFF`, uint8_t loads) become
+// SAD. The four lanes of one instruction all have the same signedness.
+// Longer add trees (8, 12, 16+ abs-diffs) are split into groups of four bytes
+// that share a packed word per operand; the groups become SAD calls chained
+// through rs3 and any terms left over are added normally.
+//
+// Abs-diffs of unsigned halfwords (`(uint16_t)a`, `a >> 16`, uint16_t loads
+// of 10/12-bit pixels) are packed the same way, two lanes per word, into
+// SAD16:
+//   rd = |rs1[15:0] - rs2[15:0]| + |rs1[31:16] - rs2[31:16]| + rs3
+//
+// Products of halfwords in the same kind of add tree, as in a 16-bit FIR
+// (`acc += x[i] * h[i]` over int16_t, or the halves of packed registers),
+// are paired the same way into DMADD16 (DMADD16U for uint16_t):
+//   rd = rs1[15:0] * rs2[15:0] + rs1[31:16] * rs2[31:16] + rs3
+// A product without a partner is left to MADD.
+//
+// Byte products (the MACs of an int8 layer) are packed four to a word
+// into DOT4 (int8_t x int8_t), DOT4U (uint8_t x uint8_t) or DOT4US (uint8_t
+// activations x int8_t weights; the operands are swapped for int8_t x
+// uint8_t):
+//   rd = rs1[7:0] * rs2[7:0] + ... + rs1[31:24] * rs2[31:24] + rs3
+// with unused lanes cleared when only two or three products share a word.
+//
+// It also recognizes abs-diff reduction loops such as:
+//   for (i = 0; i < n; i++)
+//     acc += abs(a[i] - b[i]);
+//
+// over uint8_t, int8_t or uint16_t arrays and emits a SAD (SADS for int8_t,
+// SAD16 for uint16_t) loop in front of them that consumes one word of each
+// array per iteration. Byte dot-product loops, `acc += a[i] * w[i]`, get a
+// DOT4 loop in the same way. The original loop is kept as the scalar epilogue for
+// the remaining elements (or for the whole trip count when the pointers turn
+// out not to be word aligned).
+//
+// Finally, serial MADD, SAD, DMADD16 and DOT4 accumulations such as
+//   sum += p0 * k0; sum += p1 * k1; ...      (one MADD each)
+//   sad = sad(a0, b0, sad); sad = sad(a1, b1, sad); ...
+// are split into independent accumulators that are added together at the
+// end, so that consecutive MADDs/SADs do not wait for each other. The number
+// of accumulators comes from the scheduling model (latency times issue rate
+// of the instruction), which is 2 for all of them on biriscv.
+//
+// <4 x i8> and <2 x i16> arithmetic (uint8x4_t code, vectorizer output)
+// that one packed instruction implements is rewritten into the i32
+// intrinsic on the bitcast operands: add/sub -> add.b/sub.b (add16/sub16 for
+// halfwords), uadd.sat/usub.sat -> addus.b/subus.b, umin/umax ->
+// minu.b/maxu.b, and the widened rounding average
+// trunc((zext(a) + zext(b) + 1) >> 1) -> avgu.b. Abs-diff reductions
+// vector.reduce.add(abs(sub(ext(a), ext(b)))) become sad, sads or sad16,
+// and byte dot products vector.reduce.add(mul(ext(a), ext(b))) dot4, dot4u
+// or dot4us.
+//
+// Element-wise loops over uint8_t or uint16_t arrays built from the same
+// operations, e.g.
+//   for (i = 0; i < n; i++)
+//     dst[i] = (a[i] + b[i] + 1) >> 1;
+// get a packed loop in front of them that computes a word of dst per
+// iteration, in the same way as the SAD loops above.
+//
+// The pass runs in the optimization pipeline ahead of the vectorizer and the
+// loop unroller (new pass manager, also available as
+// `opt -passes=riscv-biriscv-patterns`) and again in the codegen IR pipeline
+// for input that did not go through it.
 //
 //===----------------------------------------------------------------------===//
 
 #include "RISCV.h"
 #include "RISCVSubtarget.h"
 #include "RISCVTargetMachine.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/DomTreeUpdater.h"
+#include "llvm/Analysis/Loads.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
 #include "llvm/IR/Constants.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/IntrinsicsRISCV.h"
 #include "llvm/IR/PatternMatch.h"
+#include "llvm/IR/ValueHandle.h"
+#include "llvm/InitializePasses.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/KnownBits.h"
+#include "llvm/Transforms/Utils/Local.h"
+#include "llvm/Transforms/Utils/LoopUtils.h"
+#include "llvm/Transforms/Utils/ScalarEvolutionExpander.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <optional>
 
 using namespace llvm;
 using namespace PatternMatch;
 
 #define DEBUG_TYPE "riscv-biriscv-patterns"
 
+STATISTIC(NumSADFormed, "Number of SAD instructions formed from add trees");
+STATISTIC(NumSignedSADFormed,
+          "Number of SADS instructions formed from signed byte add trees");
+STATISTIC(NumSAD16Formed,
+          "Number of SAD16 instructions formed from halfword add trees");
+STATISTIC(NumPartialSADFormed,
+          "Number of SAD instructions formed with cleared lanes");
+STATISTIC(NumSADLoopsFormed, "Number of SAD loops formed");
+STATISTIC(NumDMADD16Formed,
+          "Number of DMADD16/DMADD16U instructions formed from add trees");
+STATISTIC(NumDOT4Formed,
+          "Number of DOT4/DOT4U/DOT4US instructions formed from add trees");
+STATISTIC(NumPartialDOT4Formed,
+          "Number of DOT4 instructions formed with cleared lanes");
+STATISTIC(NumDOT4LoopsFormed, "Number of DOT4 loops formed");
+STATISTIC(NumAbsDiffsPacked, "Number of byte abs-diffs packed into SADs");
+STATISTIC(NumAccChainsSplit,
+          "Number of MADD/SAD/DOT4 accumulator chains split into several");
+STATISTIC(NumAbsDiffsScalar,
+          "Number of byte abs-diffs in SAD add trees left scalar");
+STATISTIC(NumPackedOps, "Number of <4 x i8>/<2 x i16> operations turned "
+                        "into packed instructions");
+STATISTIC(NumPackedLoopsFormed,
+          "Number of element-wise byte/halfword loops turned into packed loops");
+
+static cl::opt<unsigned> NumAccumulators(
+    "riscv-biriscv-accumulators", cl::Hidden, cl::init(0),
+    cl::desc("Number of accumulators to split MADD/SAD chains into "
+             "(0 = from the scheduling model, 1 = do not split)"));
+
+// Set on the instructions of an accumulator chain that was already split, so
+// that the second run of the pass leaves it alone
+static const char *const AccSplitMDName = "riscv.biriscv.acc.split";
+
+// Operations in the expression stored by an element-wise loop that
+// formPackedMapLoop looks through
+static const unsigned MaxPackedMapDepth = 8;
+
 namespace {
 
-class RISCVBiRiscVPatterns : public FunctionPass {
-  const DataLayout *DL = nullptr;
-  const RISCVSubtarget *ST = nullptr;
+// Where one byte or halfword operand of an abs-diff comes from: the lane at
+// byte offset ByteIndex of a packed register value, or an i8/i16 load whose
+// lane is only known once the addresses of all loads of the word have been
+// compared (see assignByteLanes).
+struct ByteSource {
+  Value *Base = nullptr;      // Packed register, or the i8/i16 load itself
+  const SCEV *Addr = nullptr; // Load address (memory sources only)
+  unsigned ByteIndex = 0;
+  unsigned Width = 1;         // Lane width in bytes, 2 for SAD16/DMADD16
+  bool IsSigned = false;      // Byte is sign-extended (SADS, DOT4 lane)
+
+  bool isMemory() const { return Addr != nullptr; }
+};
+
+// One |a - b| leaf of an add tree whose operands are both bytes or both
+// halfwords, or with IsProduct an a * b leaf. Products are grouped into packed
+// words like the abs-diffs and become DMADD16/DMADD16U (halfwords) or
+// DOT4/DOT4U/DOT4US (bytes). A byte product of mixed signedness has its
+// unsigned operand in A, as DOT4US reads it.
+struct AbsDiffInfo {
+  ByteSource A;
+  ByteSource B;
+  Value *AbsValue = nullptr;
+  bool IsProduct = false;
+};
+
+// A single-block loop that accumulates |a[i] - b[i]| over bytes or halfwords,
+// or a[i] * b[i] over bytes, into an i32 phi, one element pair per iteration.
+struct SADReductionLoop {
+  PHINode *AccPhi = nullptr;      // Loop-carried accumulator
+  Instruction *AccNext = nullptr; // AccPhi + |a[i] - b[i]|
+  const SCEV *StartA = nullptr;   // Address of a[0] for the first iteration
+  const SCEV *StartB = nullptr;   // Address of b[0] for the first iteration
+  const SCEV *TripCount = nullptr;
+  unsigned Width = 1;             // Element size, 2 for uint16_t (SAD16)
+  bool IsSigned = false;          // int8_t streams, summed with SADS
+  bool IsProduct = false;         // Dot product, summed with a DOT4
+  bool IsSignedB = false;         // Products: b[i] is int8_t (a[i] IsSigned)
+};
+
+// A loop that stores an element-wise function of uint8_t (or uint16_t)
+// arrays, dst[i] = f(a[i], b[i], ...), where f is made of operations that
+// packed instructions implement (see matchPackedMapLoop).
+struct PackedMapLoop {
+  StoreInst *Store = nullptr;        // The store to dst[i]
+  const SCEV *StartD = nullptr;      // Address of dst[0]
+  SmallVector<LoadInst *, 4> Loads;  // The array elements f reads
+  SmallVector<Instruction *, 8> Ops; // The operations of f, operands first
+  const SCEV *TripCount = nullptr;
+  unsigned Width = 1;                // Element size, 2 for uint16_t
+};
+
+// The pattern matching itself, shared by the legacy and new pass manager
+// passes below.
+class BiRiscVPatternMatcher {
+  const RISCVSubtarget *ST;
+  const DataLayout *DL;
+  LoopInfo *LI;
+  ScalarEvolution *SE;
+  DominatorTree *DT;
+  OptimizationRemarkEmitter *ORE;
+
+  // Byte abs-diff classification of add-tree leaves (see classifyLeaf)
+  DenseMap<Value *, std::optional<AbsDiffInfo>> LeafCache;
 
+public:
+  BiRiscVPatternMatcher(const RISCVSubtarget &ST, const DataLayout &DL,
+                        LoopInfo &LI, ScalarEvolution &SE, DominatorTree &DT,
+                        OptimizationRemarkEmitter &ORE)
+      : ST(&ST), DL(&DL), LI(&LI), SE(&SE), DT(&DT), ORE(&ORE) {}
+
+  bool run(Function &Fn);
+
+private:
+  bool trySADReplacement(Instruction *Add);
+  bool classifyLeaf(Value *V, AbsDiffInfo &Info);
+  bool matchByteExtraction(Value *V, ByteSource &Src);
+  bool matchAbsoluteDifference(Value *V, Value *&LHS, Value *&RHS);
+  bool assignByteLanes(ArrayRef<ByteSource *> Sources);
+  LoadInst *findPackedLoadPoint(ArrayRef<ByteSource *> Sources);
+  Value *materializePackedWord(ArrayRef<ByteSource *> Sources);
+  void getBytePosition(const ByteSource &Src,
+                       SmallVectorImpl<const SCEV *> &Streams,
+                       const void *&Stream, int64_t &Pos);
+  bool assignGroupLanes(ArrayRef<AbsDiffInfo *> Group, Instruction *Root);
+  void partitionAbsDiffs(Instruction *Root, MutableArrayRef<AbsDiffInfo> Diffs,
+                         SmallVectorImpl<SmallVector<AbsDiffInfo *, 4>> &Groups,
+                         SmallVectorImpl<AbsDiffInfo *> &Leftover);
+  Value *emitWordLoad(IRBuilder<> &Builder, Value *Ptr, Instruction *CxtI,
+                      unsigned UsedBytes = 0xF);
+
+  bool matchByteLoadStream(Value *V, const Loop *L, const SCEV *&Start,
+                           unsigned &Width, bool &IsSigned);
+  bool matchSADReductionLoop(Loop *L, SADReductionLoop &R);
+  bool formSADReductionLoop(Loop *L);
+  bool matchPackedMapExpr(Value *V, const Loop *L, PackedMapLoop &R,
+                          unsigned Depth = 0);
+  bool matchPackedMapLoop(Loop *L, PackedMapLoop &R);
+  bool formPackedMapLoop(Loop *L);
+  Value *emitAlignmentChecks(IRBuilder<> &Builder, Value *Enter,
+                             ArrayRef<Value *> Starts,
+                             const Instruction *RemarkAt, StringRef LoopKind);
+  void finishWordLoop(Loop *L, BasicBlock *Preheader, BasicBlock *Body,
+                      BasicBlock *Middle, Value *Done, PHINode *AccPhi,
+                      Value *AccResult, StringRef EpilogueMD);
+  void reportNonI32Accumulator(Instruction *Add);
+
+  bool lowerPackedVectorOps(Function &Fn);
+
+  unsigned getAccumulatorCount(unsigned Opcode) const;
+  bool splitAccumulatorChain(ArrayRef<Instruction *> Links, bool IsSAD);
+  bool splitAccumulatorChains(Function &Fn);
+};
+
+class RISCVBiRiscVPatterns : public FunctionPass {
 public:
   static char ID; // Pass identification
 
@@ -54,26 +291,33 @@ public:
   bool runOnFunction(Function &Fn) override;
 
   void getAnalysisUsage(AnalysisUsage &AU) const override {
-    AU.setPreservesCFG();
     AU.addRequired<TargetPassConfig>();
+    AU.addRequired<DominatorTreeWrapperPass>();
+    AU.addRequired<LoopInfoWrapperPass>();
+    AU.addRequired<ScalarEvolutionWrapperPass>();
+    AU.addRequired<OptimizationRemarkEmitterWrapperPass>();
+    AU.addPreserved<DominatorTreeWrapperPass>();
+    AU.addPreserved<LoopInfoWrapperPass>();
   }
 
   StringRef getPassName() const override {
     return "RISCV BiRiscV Pattern Recognition";
   }
-
-private:
-  bool trySADReplacement(Instruction *Add);
-  bool matchByteExtraction(Value *V, Value *&BaseValue, unsigned &ByteIndex);
-  bool matchAbsoluteDifference(Value *V, Value *&LHS, Value *&RHS);
 };
 
 } // end anonymous namespace
 
 char RISCVBiRiscVPatterns::ID = 0;
 
-INITIALIZE_PASS(RISCVBiRiscVPatterns, DEBUG_TYPE,
-                "RISCV BiRiscV Pattern Recognition", false, false)
+INITIALIZE_PASS_BEGIN(RISCVBiRiscVPatterns, DEBUG_TYPE,
+                      "RISCV BiRiscV Pattern Recognition", false, false)
+INITIALIZE_PASS_DEPENDENCY(TargetPassConfig)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(OptimizationRemarkEmitterWrapperPass)
+INITIALIZE_PASS_END(RISCVBiRiscVPatterns, DEBUG_TYPE,
+                    "RISCV BiRiscV Pattern Recognition", false, false)
 
 FunctionPass *llvm::createRISCVBiRiscVPatternsPass() {
   return new RISCVBiRiscVPatterns();
@@ -83,23 +327,91 @@ FunctionPass *llvm::createRISCVBiRiscVPatternsPass() {
 // Pattern 1: (sra (shl x, 24-8*i), 24)  - extracts byte i with sign extension
 // Pattern 2: (and (lshr x, 8*i), 0xFF)  - extracts byte i with zero extension
 // Pattern 3: (trunc (lshr x, 8*i))      - extracts byte i via truncation
-bool RISCVBiRiscVPatterns::matchByteExtraction(Value *V, Value *&BaseValue,
-                                                unsigned &ByteIndex) {
+// Pattern 4: (load i8 p)                 - byte in memory, lane assigned later
+// and the halfword ones SAD16 and DMADD16 pack:
+// Pattern 5: (and x, 0xFFFF), (lshr x, 16), (trunc (lshr x, 16*i)) to i16
+// Pattern 6: (load i16 p)
+// Pattern 7: (ashr (shl x, 16), 16), (ashr x, 16) - signed halfwords
+// Src.IsSigned tells whether the lane is sign- or zero-extended: an extension
+// of the i8/i16 value decides, otherwise the extraction pattern itself.
+bool BiRiscVPatternMatcher::matchByteExtraction(Value *V, ByteSource &Src) {
+  Value *&BaseValue = Src.Base;
+  unsigned &ByteIndex = Src.ByteIndex;
 
   // Look through casts (ZExt, SExt, Trunc) to find the actual byte extraction
   // This is necessary because LLVM may insert casts for type conversions
   if (auto *CI = dyn_cast<CastInst>(V)) {
+    unsigned DstBits = CI->getDestTy()->getScalarSizeInBits();
+    if (CI->getOpcode() == Instruction::Trunc) {
+      // A truncation to i8/i16 keeps the low byte or halfword of whatever it
+      // truncates, or is itself the extraction of an aligned lane of an i32
+      Value *Op = CI->getOperand(0);
+      if (matchByteExtraction(Op, Src)) {
+        if (DstBits == 8 || DstBits == 16)
+          Src.Width = std::min(Src.Width, DstBits / 8);
+        return true;
+      }
+
+      if ((DstBits != 8 && DstBits != 16) || !Op->getType()->isIntegerTy(32))
+        return false;
+      Value *Packed = Op;
+      const APInt *Shift = nullptr;
+      match(Op, m_LShr(m_Value(Packed), m_APInt(Shift)));
+      unsigned Offset = Shift ? Shift->getZExtValue() : 0;
+      if (Offset % DstBits != 0 || Offset >= 32)
+        return false;
+      BaseValue = Packed;
+      ByteIndex = Offset / 8;
+      Src.Width = DstBits / 8;
+      Src.IsSigned = false;
+      return true;
+    }
+
     if (CI->getOpcode() == Instruction::ZExt ||
-        CI->getOpcode() == Instruction::SExt ||
-        CI->getOpcode() == Instruction::Trunc) {
+        CI->getOpcode() == Instruction::SExt) {
       // Recursively match on the source of the cast
-      return matchByteExtraction(CI->getOperand(0), BaseValue, ByteIndex);
+      if (!matchByteExtraction(CI->getOperand(0), Src))
+        return false;
+
+      // The outermost extension of the i8/i16 value is how the lane is read.
+      // Zero-extending a lane that was already sign-extended to a wider type
+      // is neither a signed nor an unsigned lane.
+      if (CI->getSrcTy()->getScalarSizeInBits() == 8 * Src.Width)
+        Src.IsSigned = CI->getOpcode() == Instruction::SExt;
+      else if (CI->getOpcode() == Instruction::ZExt && Src.IsSigned)
+        return false;
+      return true;
     }
   }
 
+  // Pattern: byte or halfword load from memory, e.g. uint8_t x = ptr[i]
+  // The address is kept as a SCEV so any GEP shape (multi-index, induction
+  // variable offsets, pointer arithmetic on arguments) compares the same way
+  if (auto *Load = dyn_cast<LoadInst>(V)) {
+    if (!Load->isSimple() || (!Load->getType()->isIntegerTy(8) &&
+                              !Load->getType()->isIntegerTy(16)))
+      return false;
+
+    // Unsigned unless an enclosing extension says otherwise
+    BaseValue = Load;
+    Src.IsSigned = false;
+    Src.Addr = SE->getSCEV(Load->getPointerOperand());
+    Src.Width = Load->getType()->getIntegerBitWidth() / 8;
+    return true;
+  }
+
+  // The register patterns take a lane of X, which has the type of V and
+  // becomes the i32 operand of the SAD/DOT4 intrinsic
+  if (!V->getType()->isIntegerTy(32))
+    return false;
+
   // Try to match: (ashr (shl X, C1), 24) where C1 = 24, 16, 8, 0
   Value *ShiftVal;
   const APInt *ShiftAmt1, *ShiftAmt2;
+  Src.Width = 1;
+
+  // The ashr patterns sign-extend the byte
+  Src.IsSigned = true;
 
   // Pattern: (ashr (shl X, C1), 24)
   if (match(V, m_AShr(m_Shl(m_Value(ShiftVal), m_APInt(ShiftAmt1)),
@@ -122,6 +434,20 @@ bool RISCVBiRiscVPatterns::matchByteExtraction(Value *V, Value *&BaseValue,
     }
   }
 
+  // Pattern: (ashr (shl X, 16), 16) and (ashr X, 16) - signed halfwords
+  if (V->getType()->isIntegerTy(32) &&
+      match(V, m_AShr(m_Value(ShiftVal), m_SpecificInt(16)))) {
+    Value *Packed;
+    bool IsLow = match(ShiftVal, m_Shl(m_Value(Packed), m_SpecificInt(16)));
+    BaseValue = IsLow ? Packed : ShiftVal;
+    ByteIndex = IsLow ? 0 : 2;
+    Src.Width = 2;
+    return true;
+  }
+
+  // The remaining patterns zero-extend it
+  Src.IsSigned = false;
+
   // Pattern: (and (lshr X, C), 0xFF)
   if (match(V, m_And(m_LShr(m_Value(ShiftVal), m_APInt(ShiftAmt1)),
                      m_SpecificInt(0xFF)))) {
@@ -139,53 +465,374 @@ bool RISCVBiRiscVPatterns::matchByteExtraction(Value *V, Value *&BaseValue,
     return true;
   }
 
+  // Pattern: (and X, 0xFFFF) - extracts halfword 0
+  if (match(V, m_And(m_Value(ShiftVal), m_SpecificInt(0xFFFF)))) {
+    ByteIndex = 0;
+    BaseValue = ShiftVal;
+    Src.Width = 2;
+    return true;
+  }
+
   // Pattern: (lshr X, C) where C = 8, 16, or 24 (without explicit and mask)
-  // This happens when LLVM knows the upper bits are already zero
-  if (match(V, m_LShr(m_Value(ShiftVal), m_APInt(ShiftAmt1)))) {
+  // The result is a byte when LLVM knows the upper bits are already zero,
+  // and for C = 16 the upper halfword otherwise
+  if (match(V, m_LShr(m_Value(ShiftVal), m_APInt(ShiftAmt1))) &&
+      V->getType()->isIntegerTy(32)) {
     unsigned shift = ShiftAmt1->getZExtValue();
-    if (shift == 8)  { ByteIndex = 1; BaseValue = ShiftVal; return true; }
-    if (shift == 16) { ByteIndex = 2; BaseValue = ShiftVal; return true; }
-    if (shift == 24) { ByteIndex = 3; BaseValue = ShiftVal; return true; }
+    unsigned ActiveBits = computeKnownBits(V, *DL).countMaxActiveBits();
+    if (shift == 24 || ((shift == 8 || shift == 16) && ActiveBits <= 8)) {
+      ByteIndex = shift / 8;
+      BaseValue = ShiftVal;
+      return true;
+    }
+    if (shift == 16) {
+      ByteIndex = 2;
+      BaseValue = ShiftVal;
+      Src.Width = 2;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Check that the byte sources of one SAD operand form a single packed word
+// and set their lane. Register sources must share the packed value; memory
+// sources must sit at constant distances from each other, with the lowest
+// address becoming lane 0 and halfwords two bytes apart.
+bool BiRiscVPatternMatcher::assignByteLanes(ArrayRef<ByteSource *> Sources) {
+  ByteSource *First = Sources.front();
+
+  if (!First->isMemory()) {
+    for (ByteSource *Src : Sources)
+      if (Src->isMemory() || Src->Base != First->Base || Src->ByteIndex >= 4)
+        return false;
+    return true;
   }
 
-  // Pattern: load from memory (getelementptr ptr, offset)
-  // This is for cases like: uint8_t x = ptr[i]
-  // We need to extract the base pointer and offset
-  if (auto *LI = dyn_cast<LoadInst>(V)) {
-    Value *Ptr = LI->getPointerOperand();
+  SmallVector<int64_t, 4> Offsets;
+  int64_t MinOffset = 0;
+  for (ByteSource *Src : Sources) {
+    if (!Src->isMemory())
+      return false;
+    std::optional<APInt> Diff =
+        SE->computeConstantDifference(Src->Addr, First->Addr);
+    if (!Diff)
+      return false;
+    Offsets.push_back(Diff->getSExtValue());
+    MinOffset = std::min(MinOffset, Offsets.back());
+  }
 
-    // Check if it's a direct load from base pointer (offset 0)
-    if (isa<Argument>(Ptr) || isa<AllocaInst>(Ptr)) {
-      ByteIndex = 0;
-      BaseValue = Ptr;
-      return true;
+  for (auto [Src, Offset] : zip(Sources, Offsets)) {
+    if (Offset - MinOffset >= 4 || (Offset - MinOffset) % Src->Width)
+      return false;
+    Src->ByteIndex = Offset - MinOffset;
+  }
+
+  return true;
+}
+
+// Load a packed word from Ptr, of which the original code read the bytes in
+// UsedBytes (bit i for byte i), using the cheapest sequence the alignment
+// allows. Word accesses trap on misaligned addresses, so a plain lw is only
+// emitted when the alignment is known, provable from the address recurrence,
+// or can be enforced on the underlying object. Other bytes are only read when
+// the whole word is known to be dereferenceable; otherwise exactly the used
+// bytes are loaded with halfword and byte loads and the other lanes are zero.
+Value *BiRiscVPatternMatcher::emitWordLoad(IRBuilder<> &Builder, Value *Ptr,
+                                          Instruction *CxtI,
+                                          unsigned UsedBytes) {
+  Type *I32Ty = Builder.getInt32Ty();
+  bool WholeWord = UsedBytes == 0xF ||
+                   isDereferenceablePointer(Ptr, I32Ty, *DL, CxtI, nullptr, DT);
+  Align Known =
+      WholeWord
+          ? getOrEnforceKnownAlignment(Ptr, Align(4), *DL, CxtI, nullptr, DT)
+          : getKnownAlignment(Ptr, *DL, CxtI, nullptr, DT);
+  if (Known < Align(4) && SE->getMinTrailingZeros(SE->getSCEV(Ptr)) >= 2)
+    Known = Align(4);
+
+  if (WholeWord && Known >= Align(4))
+    return Builder.CreateAlignedLoad(I32Ty, Ptr, Align(4));
+
+  // lhu where halfword aligned, lbu otherwise, shifted into place and or-ed
+  // together (lhu + lhu + slli + or for a halfword-aligned word)
+  Value *Word = nullptr;
+  for (unsigned Offset = 0; Offset < 4;) {
+    if (!(UsedBytes >> Offset & 1)) {
+      ++Offset;
+      continue;
     }
+    unsigned Size =
+        Known >= Align(2) && Offset % 2 == 0 && (UsedBytes >> Offset & 3) == 3
+            ? 2
+            : 1;
+    Value *Part = Builder.CreateAlignedLoad(
+        Builder.getIntNTy(8 * Size),
+        Builder.CreateConstGEP1_32(Builder.getInt8Ty(), Ptr, Offset),
+        Align(Size));
+    Part = Builder.CreateZExt(Part, I32Ty);
+    if (Offset)
+      Part = Builder.CreateShl(Part, 8 * Offset);
+    Word = Word ? Builder.CreateOr(Word, Part) : Part;
+    Offset += Size;
+  }
+  return Word;
+}
 
-    // Check if it's a GEP (getelementptr) with constant offset
-    if (auto *GEP = dyn_cast<GetElementPtrInst>(Ptr)) {
-      if (GEP->getNumIndices() == 1) {
-        Value *BasePtr = GEP->getPointerOperand();
-        Value *Idx = GEP->getOperand(1);
-
-        if (auto *CI = dyn_cast<ConstantInt>(Idx)) {
-          uint64_t offset = CI->getZExtValue();
-          if (offset <= 3) {
-            ByteIndex = offset;
-            BaseValue = BasePtr;
-            return true;
-          }
-        }
+// For memory sources, return the last of the byte loads when one word load
+// placed right after it can replace them all: the loads must be in one block
+// with no store in between. Returns nullptr otherwise.
+LoadInst *
+BiRiscVPatternMatcher::findPackedLoadPoint(ArrayRef<ByteSource *> Sources) {
+  Instruction *First = nullptr;
+  LoadInst *Last = nullptr;
+  for (ByteSource *Src : Sources) {
+    auto *Load = cast<LoadInst>(Src->Base);
+    if (First && Load->getParent() != First->getParent())
+      return nullptr;
+    if (!First || Load->comesBefore(First))
+      First = Load;
+    if (!Last || Last->comesBefore(Load))
+      Last = Load;
+  }
+
+  for (Instruction *I = First; I != Last; I = I->getNextNode())
+    if (I->mayWriteToMemory())
+      return nullptr;
+
+  return Last;
+}
+
+// Produce the packed i32 for one SAD operand whose lanes have been assigned.
+// Lanes that no source uses hold unspecified bytes. Returns nullptr if the
+// memory sources cannot be merged into one access.
+Value *BiRiscVPatternMatcher::materializePackedWord(
+    ArrayRef<ByteSource *> Sources) {
+  if (!Sources.front()->isMemory())
+    return Sources.front()->Base;
+
+  LoadInst *Last = findPackedLoadPoint(Sources);
+  if (!Last)
+    return nullptr;
+
+  auto *Lane0 = find_if(Sources, [](ByteSource *Src) {
+    return Src->ByteIndex == 0;
+  });
+  unsigned UsedBytes = 0;
+  for (ByteSource *Src : Sources)
+    UsedBytes |= ((1u << Src->Width) - 1) << Src->ByteIndex;
+
+  Value *Ptr = cast<LoadInst>((*Lane0)->Base)->getPointerOperand();
+  IRBuilder<> Builder(Last->getNextNode());
+  return emitWordLoad(Builder, Ptr, Last, UsedBytes);
+}
+
+// Place a byte source in a stream of bytes that may be packed together.
+// Register sources belong to their packed value at their lane; memory sources
+// belong to the first address seen at a constant distance from theirs, at
+// that distance.
+void BiRiscVPatternMatcher::getBytePosition(
+    const ByteSource &Src, SmallVectorImpl<const SCEV *> &Streams,
+    const void *&Stream, int64_t &Pos) {
+  if (!Src.isMemory()) {
+    Stream = Src.Base;
+    Pos = Src.ByteIndex;
+    return;
+  }
+
+  for (const SCEV *Start : Streams) {
+    if (std::optional<APInt> Diff =
+            SE->computeConstantDifference(Src.Addr, Start)) {
+      Stream = Start;
+      Pos = Diff->getSExtValue();
+      return;
+    }
+  }
+
+  Streams.push_back(Src.Addr);
+  Stream = Src.Addr;
+  Pos = 0;
+}
+
+// Assign the lanes of a candidate group and check that both of its operands
+// can be produced as one packed word.
+bool BiRiscVPatternMatcher::assignGroupLanes(ArrayRef<AbsDiffInfo *> Group,
+                                             Instruction *Root) {
+  SmallVector<ByteSource *, 4> SourcesA, SourcesB;
+  for (AbsDiffInfo *Info : Group) {
+    SourcesA.push_back(&Info->A);
+    SourcesB.push_back(&Info->B);
+  }
+
+  if (!assignByteLanes(SourcesA) || !assignByteLanes(SourcesB))
+    return false;
+
+  for (AbsDiffInfo *Info : Group)
+    if (Info->A.ByteIndex != Info->B.ByteIndex)
+      return false;
+
+  for (ArrayRef<ByteSource *> Sources : {SourcesA, SourcesB}) {
+    if (Sources.front()->isMemory() && !findPackedLoadPoint(Sources)) {
+      ORE->emit([&]() {
+        return OptimizationRemarkMissed(DEBUG_TYPE, "LoadsNotMergeable", Root)
+               << "byte loads of a SAD operand are in different blocks or "
+                  "separated by a store";
+      });
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Partition the abs-diffs of one add tree into SAD groups, and its products
+// into DMADD16 or DOT4 groups. Terms are bucketed by the streams their two
+// operands come from, the distance between the two positions and the kind of
+// lane (SAD, SADS, SAD16, DMADD16 or one of the DOT4s); within a
+// bucket, the lanes of one word at consecutive positions (four bytes or two
+// halfwords) make one group, taken greedily from the lowest, and what remains
+// is packed into partial groups within one word. Everything that does not
+// end up in a group is returned in Leftover.
+void BiRiscVPatternMatcher::partitionAbsDiffs(
+    Instruction *Root, MutableArrayRef<AbsDiffInfo> Diffs,
+    SmallVectorImpl<SmallVector<AbsDiffInfo *, 4>> &Groups,
+    SmallVectorImpl<AbsDiffInfo *> &Leftover) {
+  using BucketKey =
+      std::tuple<const void *, const void *, int64_t, unsigned, bool, bool,
+                 bool>;
+  using PositionMap = std::map<int64_t, SmallVector<AbsDiffInfo *, 1>>;
+  MapVector<BucketKey, PositionMap> Buckets;
+  SmallVector<const SCEV *, 4> Streams;
+
+  for (AbsDiffInfo &Info : Diffs) {
+    const void *StreamA, *StreamB;
+    int64_t PosA, PosB;
+    getBytePosition(Info.A, Streams, StreamA, PosA);
+    getBytePosition(Info.B, Streams, StreamB, PosB);
+    BucketKey Key = {StreamA,         StreamB,         PosA - PosB,
+                     Info.A.Width,    Info.A.IsSigned, Info.B.IsSigned,
+                     Info.IsProduct};
+    Buckets[Key][PosA].push_back(&Info);
+  }
+
+  if (Buckets.size() > 1) {
+    ORE->emit([&]() {
+      return OptimizationRemarkAnalysis(DEBUG_TYPE, "BasesDiffer", Root)
+             << "byte abs-diffs read from "
+             << ore::NV("NumWordPairs", unsigned(Buckets.size()))
+             << " different pairs of packed words (bases differ)";
+    });
+  }
+
+  // One abs-diff from each occupied lane of the window [Pos, Pos + 4)
+  auto CollectWindow = [](PositionMap &Positions, int64_t Pos, unsigned Width) {
+    SmallVector<AbsDiffInfo *, 4> Window;
+    for (int64_t Lane = 0; Lane < 4; Lane += Width) {
+      auto It = Positions.find(Pos + Lane);
+      if (It != Positions.end())
+        Window.push_back(It->second.back());
+    }
+    return Window;
+  };
+  auto TakeLowest = [](PositionMap &Positions) {
+    auto It = Positions.begin();
+    AbsDiffInfo *Info = It->second.pop_back_val();
+    if (It->second.empty())
+      Positions.erase(It);
+    return Info;
+  };
+  auto TakeWindow = [&](PositionMap &Positions, int64_t Pos, unsigned Width,
+                        unsigned Size) {
+    for (int64_t Lane = 0; Lane < 4 && Size; Lane += Width) {
+      auto It = Positions.find(Pos + Lane);
+      if (It == Positions.end())
+        continue;
+      It->second.pop_back();
+      if (It->second.empty())
+        Positions.erase(It);
+      --Size;
+    }
+  };
+
+  for (auto &Bucket : Buckets) {
+    PositionMap &Positions = Bucket.second;
+    unsigned Width = std::get<3>(Bucket.first);
+    bool IsProduct = std::get<6>(Bucket.first);
+    unsigned NumLanes = 4 / Width;
+    StringRef LaneKind = Width == 1 ? "byte" : "halfword";
+
+    // Full groups first: a full group holding the lowest position has to
+    // start there, otherwise that position is set aside
+    PositionMap Remaining;
+    while (!Positions.empty()) {
+      int64_t Pos = Positions.begin()->first;
+      SmallVector<AbsDiffInfo *, 4> Group =
+          CollectWindow(Positions, Pos, Width);
+      if (Group.size() == NumLanes && assignGroupLanes(Group, Root)) {
+        Groups.push_back(Group);
+        TakeWindow(Positions, Pos, Width, NumLanes);
+        continue;
       }
+      Remaining[Pos].push_back(TakeLowest(Positions));
+    }
+
+    // Then the leftover terms within a word become a SAD or DOT4 with the
+    // unused lanes cleared on both operands. A lone byte or halfword from
+    // memory would need two word loads and two masks where the scalar code
+    // has two lbu/lhu, so that one stays scalar, and a lone product is a MADD
+    // already.
+    while (!Remaining.empty()) {
+      int64_t Pos = Remaining.begin()->first;
+      SmallVector<AbsDiffInfo *, 4> Group =
+          CollectWindow(Remaining, Pos, Width);
+      bool ReadsMemory = Group.front()->A.isMemory() ||
+                         Group.front()->B.isMemory();
+      bool KeepScalar = Group.size() == 1 && (ReadsMemory || IsProduct);
+      if (!KeepScalar && assignGroupLanes(Group, Root)) {
+        ORE->emit([&]() {
+          return OptimizationRemarkAnalysis(DEBUG_TYPE, "PartialLanes", Root)
+                 << ore::NV("Lanes", unsigned(Group.size())) << " of "
+                 << ore::NV("NumLanes", NumLanes) << " " << LaneKind
+                 << " lanes matched; the unused lanes are cleared";
+        });
+        Groups.push_back(Group);
+        TakeWindow(Remaining, Pos, Width, Group.size());
+        continue;
+      }
+      if (Group.size() == 1 && ReadsMemory && !IsProduct) {
+        ORE->emit([&]() {
+          return OptimizationRemarkMissed(DEBUG_TYPE, "LoneByte", Root)
+                 << "1 of " << ore::NV("NumLanes", NumLanes) << " "
+                 << LaneKind << " lanes matched; a lone " << LaneKind
+                 << " from memory is cheaper as scalar code";
+        });
+      }
+      Leftover.push_back(TakeLowest(Remaining));
     }
   }
+}
 
+// Whether an icmp that orders CmpOp orders SubOp, the operand of an abs-diff
+// subtraction, the same way: CmpOp is SubOp itself or the i8/i16 value it
+// extends, and the comparison reads it with the same signedness.
+static bool comparesSameValue(Value *CmpOp, Value *SubOp, bool IsSigned,
+                              const DataLayout &DL) {
+  if (CmpOp == SubOp)
+    return IsSigned || computeKnownBits(SubOp, DL).isNonNegative();
+  if (match(SubOp, m_ZExt(m_Specific(CmpOp))))
+    return !IsSigned;
+  if (match(SubOp, m_SExt(m_Specific(CmpOp))))
+    return IsSigned;
   return false;
 }
 
 // Helper function to match absolute difference patterns:
 // Pattern 1: call @llvm.abs.i32(sub(a, b), ...)
 // Pattern 2: select (icmp a > b), sub(a, b), sub(b, a)
-bool RISCVBiRiscVPatterns::matchAbsoluteDifference(Value *V, Value *&LHS, Value *&RHS) {
+// In pattern 2 the condition must select the non-negative difference:
+// (a < b) ? a - b : b - a is -|a - b|.
+bool BiRiscVPatternMatcher::matchAbsoluteDifference(Value *V, Value *&LHS, Value *&RHS) {
   // Pattern 1: abs intrinsic call
   if (auto *Call = dyn_cast<CallInst>(V)) {
     if (auto *Callee = Call->getCalledFunction()) {
@@ -203,7 +850,7 @@ bool RISCVBiRiscVPatterns::matchAbsoluteDifference(Value *V, Value *&LHS, Value
   }
 
   // Pattern 2: select-based abs
-  // Match: select (icmp X, Y), sub(X, Y), sub(Y, X)
+  // Match: select (icmp X > Y), sub(X, Y), sub(Y, X)
   if (auto *Select = dyn_cast<SelectInst>(V)) {
     Value *TrueVal = Select->getTrueValue();
     Value *FalseVal = Select->getFalseValue();
@@ -221,8 +868,23 @@ bool RISCVBiRiscVPatterns::matchAbsoluteDifference(Value *V, Value *&LHS, Value
       Value *FalseOp0 = FalseSub->getOperand(0);
       Value *FalseOp1 = FalseSub->getOperand(1);
 
-      // Check if it's abs pattern: sub(A,B) and sub(B,A)
-      if (TrueOp0 == FalseOp1 && TrueOp1 == FalseOp0) {
+      // Check if it's abs pattern: sub(A,B) and sub(B,A), taken when A >= B
+      auto *Cmp = dyn_cast<ICmpInst>(Select->getCondition());
+      if (!Cmp || TrueOp0 != FalseOp1 || TrueOp1 != FalseOp0)
+        return false;
+
+      auto TakesNonNegative = [&](CmpInst::Predicate Pred, Value *X,
+                                  Value *Y) {
+        if (!ICmpInst::isGT(Pred) && !ICmpInst::isGE(Pred))
+          return false;
+        bool IsSigned = ICmpInst::isSigned(Pred);
+        return comparesSameValue(X, TrueOp0, IsSigned, *DL) &&
+               comparesSameValue(Y, TrueOp1, IsSigned, *DL);
+      };
+      if (TakesNonNegative(Cmp->getPredicate(), Cmp->getOperand(0),
+                           Cmp->getOperand(1)) ||
+          TakesNonNegative(Cmp->getSwappedPredicate(), Cmp->getOperand(1),
+                           Cmp->getOperand(0))) {
         LHS = TrueOp0;
         RHS = TrueOp1;
         return true;
@@ -233,15 +895,109 @@ bool RISCVBiRiscVPatterns::matchAbsoluteDifference(Value *V, Value *&LHS, Value
   return false;
 }
 
+// An i32 add that can be part of a SAD reduction tree
+static bool isReductionAdd(const Value *V) {
+  auto *BO = dyn_cast<BinaryOperator>(V);
+  return BO && BO->getOpcode() == Instruction::Add &&
+         BO->getType()->isIntegerTy(32);
+}
+
+// Interior nodes of a reduction tree feed exactly one other add; any other
+// reduction add is the root of a tree
+static bool isInteriorAdd(const Value *V) {
+  return isReductionAdd(V) && V->hasOneUse() && isReductionAdd(V->user_back());
+}
+
+// Classify an add-tree leaf as a byte or halfword abs-diff. The result is
+// cached, so a leaf shared by several trees is only matched once per
+// function.
+bool BiRiscVPatternMatcher::classifyLeaf(Value *V, AbsDiffInfo &Info) {
+  auto [It, Inserted] = LeafCache.try_emplace(V);
+  if (!Inserted) {
+    if (It->second)
+      Info = *It->second;
+    return It->second.has_value();
+  }
+
+  // Try to match absolute difference (both abs() intrinsic and select-based)
+  // or a product with a byte extraction on both sides
+  Value *DiffLHS, *DiffRHS;
+  ByteSource SrcA, SrcB;
+  bool IsProduct = false;
+  if (!matchAbsoluteDifference(V, DiffLHS, DiffRHS)) {
+    IsProduct = match(V, m_Mul(m_Value(DiffLHS), m_Value(DiffRHS)));
+    if (!IsProduct)
+      return false;
+  }
+  if (!matchByteExtraction(DiffLHS, SrcA) ||
+      !matchByteExtraction(DiffRHS, SrcB))
+    return false;
+
+  // A byte against a halfword has no packed form
+  if (SrcA.Width != SrcB.Width)
+    return false;
+
+  // DMADD16/DMADD16U multiply halfword pairs of one signedness. Bytes may
+  // mix: DOT4US takes the unsigned ones from rs1.
+  if (IsProduct) {
+    if (SrcA.Width == 1 && SrcA.IsSigned && !SrcB.IsSigned)
+      std::swap(SrcA, SrcB);
+    if (SrcA.Width == 2 && SrcA.IsSigned != SrcB.IsSigned) {
+      ORE->emit([&]() {
+        return OptimizationRemarkMissed(DEBUG_TYPE, "MixedSignedness",
+                                        cast<Instruction>(V))
+               << "product of a signed and an unsigned halfword cannot use "
+                  "DMADD16 or DMADD16U";
+      });
+      return false;
+    }
+    Info = {SrcA, SrcB, V, /*IsProduct=*/true};
+    LeafCache[V] = Info;
+    return true;
+  }
+
+  // SAD and SADS read both operands the same way
+  if (SrcA.IsSigned != SrcB.IsSigned) {
+    ORE->emit([&]() {
+      return OptimizationRemarkMissed(DEBUG_TYPE, "MixedSignedness",
+                                      cast<Instruction>(V))
+             << "byte abs-diff of a signed and an unsigned byte cannot use "
+                "SAD or SADS";
+    });
+    return false;
+  }
+
+  // SAD16 only has unsigned lanes
+  if (SrcA.Width == 2 && SrcA.IsSigned) {
+    ORE->emit([&]() {
+      return OptimizationRemarkMissed(DEBUG_TYPE, "SignedHalfwords",
+                                      cast<Instruction>(V))
+             << "abs-diff of signed halfwords cannot use SAD16";
+    });
+    return false;
+  }
+
+  Info = {SrcA, SrcB, V};
+  LeafCache[V] = Info;
+  return true;
+}
+
 // Try to match SAD pattern iteratively (no recursive lambdas)
-bool RISCVBiRiscVPatterns::trySADReplacement(Instruction *RootAdd) {
+bool BiRiscVPatternMatcher::trySADReplacement(Instruction *RootAdd) {
   // Must be an add instruction with 32-bit integer type
   if (RootAdd->getOpcode() != Instruction::Add || !RootAdd->getType()->isIntegerTy(32))
     return false;
 
-  // Collect all values in the addition chain iteratively
+  // Only look at whole trees: an add feeding a single other add is part of
+  // that add's tree, and matching it on its own could pack its terms into a
+  // partial SAD that the full tree would have grouped better
+  if (isInteriorAdd(RootAdd))
+    return false;
+
+  // Collect all values in the addition chain iteratively. Only interior adds
+  // are expanded; an add with other users is a leaf here and the root of its
+  // own tree, so every add is walked exactly once per function.
   SmallVector<Value *, 16> Addends;
-  SmallVector<BinaryOperator *, 16> AddChain;
   SmallVector<Value *, 16> Worklist;
 
   Worklist.push_back(RootAdd);
@@ -250,142 +1006,1295 @@ bool RISCVBiRiscVPatterns::trySADReplacement(Instruction *RootAdd) {
   while (!Worklist.empty()) {
     Value *V = Worklist.pop_back_val();
 
-    if (auto *BO = dyn_cast<BinaryOperator>(V)) {
-      if (BO->getOpcode() == Instruction::Add &&
-          BO->getType()->isIntegerTy(32)) {
-        // Track this add instruction
-        AddChain.push_back(BO);
-        // Explore both operands
-        Worklist.push_back(BO->getOperand(0));
-        Worklist.push_back(BO->getOperand(1));
-        continue;
-      }
+    if (V == RootAdd || isInteriorAdd(V)) {
+      // Explore both operands
+      auto *BO = cast<BinaryOperator>(V);
+      Worklist.push_back(BO->getOperand(0));
+      Worklist.push_back(BO->getOperand(1));
+      continue;
     }
 
     // Not an add, this is a leaf value
     Addends.push_back(V);
   }
 
-  // We need at least 4 abs operations + maybe an accumulator
-  if (Addends.size() < 4)
+  // We need at least 2 abs operations, or 1 abs operation + an accumulator
+  if (Addends.size() < 2)
     return false;
 
-  // Try to find 4 absolute difference operations
-  struct AbsDiffInfo {
-    Value *BaseA;
-    Value *BaseB;
-    unsigned ByteIndex;
-    Value *AbsValue;
-  };
+  SmallVector<AbsDiffInfo, 16> FoundAbsDiffs;
+  SmallVector<Value *, 4> OtherAddends;
+
+  for (Value *Addend : Addends) {
+    // Found a valid abs(extract(a,i) - extract(b,j)) or halfword product;
+    // lanes are assigned when the terms are partitioned into packed words
+    AbsDiffInfo Info;
+    if (classifyLeaf(Addend, Info)) {
+      FoundAbsDiffs.push_back(Info);
+      continue;
+    }
+
+    // Accumulators and anything else are summed in front of the SADs
+    OtherAddends.push_back(Addend);
+  }
+
+  if (FoundAbsDiffs.empty())
+    return false;
+
+  // Split the abs-diffs into groups of four that each read one packed word
+  // per operand (same register, or four adjacent bytes in memory), and the
+  // halfword products into pairs
+  SmallVector<SmallVector<AbsDiffInfo *, 4>, 4> Groups;
+  SmallVector<AbsDiffInfo *, 4> Leftover;
+  partitionAbsDiffs(RootAdd, FoundAbsDiffs, Groups, Leftover);
+
+  unsigned NumDMADD16 = count_if(Groups, [](ArrayRef<AbsDiffInfo *> Group) {
+    return Group.front()->IsProduct && Group.front()->A.Width == 2;
+  });
+  unsigned NumDOT4 = count_if(Groups, [](ArrayRef<AbsDiffInfo *> Group) {
+    return Group.front()->IsProduct && Group.front()->A.Width == 1;
+  });
+  unsigned NumSAD = Groups.size() - NumDMADD16 - NumDOT4;
+  unsigned NumAbsDiffs = count_if(FoundAbsDiffs, [](const AbsDiffInfo &Info) {
+    return !Info.IsProduct;
+  });
+  unsigned NumLeftoverAbsDiffs = count_if(Leftover, [](AbsDiffInfo *Info) {
+    return !Info->IsProduct;
+  });
+
+  // Products that did not pack are left to MADD without a remark; that is
+  // what they would have been anyway
+  if (NumAbsDiffs && !NumSAD) {
+    ORE->emit([&]() {
+      return OptimizationRemarkMissed(DEBUG_TYPE, "NoSADGroup", RootAdd)
+             << ore::NV("NumAbsDiffs", NumAbsDiffs)
+             << " byte abs-diff(s) found but none could be packed into a SAD";
+    });
+  }
+  if (Groups.empty())
+    return false;
+
+  unsigned NumPacked = NumAbsDiffs - NumLeftoverAbsDiffs;
+  if (NumSAD) {
+    ORE->emit([&]() {
+      return OptimizationRemark(DEBUG_TYPE, "SADFormed", RootAdd)
+             << "formed " << ore::NV("NumSAD", NumSAD)
+             << " SAD instruction(s) from "
+             << ore::NV("NumAbsDiffs", NumPacked) << " byte abs-diffs";
+    });
+  }
+  if (NumSAD && NumLeftoverAbsDiffs) {
+    ORE->emit([&]() {
+      return OptimizationRemarkMissed(DEBUG_TYPE, "AbsDiffsLeftScalar",
+                                      RootAdd)
+             << ore::NV("NumLeftover", NumLeftoverAbsDiffs)
+             << " byte abs-diff(s) could not be packed and stay scalar";
+    });
+  }
+  if (NumDMADD16) {
+    ORE->emit([&]() {
+      return OptimizationRemark(DEBUG_TYPE, "DMADD16Formed", RootAdd)
+             << "formed " << ore::NV("NumDMADD16", NumDMADD16)
+             << " DMADD16 instruction(s) from "
+             << ore::NV("NumProducts", 2 * NumDMADD16)
+             << " halfword products";
+    });
+  }
+  if (NumDOT4) {
+    unsigned NumProducts = 0;
+    for (ArrayRef<AbsDiffInfo *> Group : Groups)
+      if (Group.front()->IsProduct && Group.front()->A.Width == 1)
+        NumProducts += Group.size();
+    ORE->emit([&]() {
+      return OptimizationRemark(DEBUG_TYPE, "DOT4Formed", RootAdd)
+             << "formed " << ore::NV("NumDOT4", NumDOT4)
+             << " DOT4 instruction(s) from "
+             << ore::NV("NumProducts", NumProducts) << " byte products";
+    });
+  }
+
+  NumSADFormed += NumSAD;
+  NumSignedSADFormed += count_if(Groups, [](ArrayRef<AbsDiffInfo *> Group) {
+    return !Group.front()->IsProduct && Group.front()->A.IsSigned;
+  });
+  NumSAD16Formed += count_if(Groups, [](ArrayRef<AbsDiffInfo *> Group) {
+    return !Group.front()->IsProduct && Group.front()->A.Width == 2;
+  });
+  NumDMADD16Formed += NumDMADD16;
+  NumDOT4Formed += NumDOT4;
+  NumAbsDiffsPacked += NumPacked;
+  NumAbsDiffsScalar += NumLeftoverAbsDiffs;
+
+  LLVM_DEBUG(dbgs() << "BiRiscV: " << NumSAD << " SAD group(s), "
+                    << NumDMADD16 << " DMADD16 group(s), " << NumDOT4
+                    << " DOT4 group(s), " << Leftover.size()
+                    << " scalar term(s) in " << *RootAdd << "\n");
+
+  // Memory operands become a single word load each
+  IRBuilder<> Builder(RootAdd);
+  SmallVector<std::tuple<Value *, Value *, Intrinsic::ID>, 4> PackedOperands;
+  for (ArrayRef<AbsDiffInfo *> Group : Groups) {
+    SmallVector<ByteSource *, 4> SourcesA, SourcesB;
+    uint32_t LaneMask = 0;
+    for (AbsDiffInfo *Info : Group) {
+      SourcesA.push_back(&Info->A);
+      SourcesB.push_back(&Info->B);
+      LaneMask |= maskTrailingOnes<uint32_t>(8 * Info->A.Width)
+                  << (8 * Info->A.ByteIndex);
+    }
+
+    Value *PackedA = materializePackedWord(SourcesA);
+    Value *PackedB = materializePackedWord(SourcesB);
+
+    // A partial group clears its unused lanes on both operands so they
+    // contribute |0 - 0| or 0 * 0, signed or not
+    bool IsProduct = Group.front()->IsProduct;
+    if (LaneMask != 0xFFFFFFFFu) {
+      PackedA = Builder.CreateAnd(PackedA, LaneMask);
+      PackedB = Builder.CreateAnd(PackedB, LaneMask);
+      if (IsProduct)
+        ++NumPartialDOT4Formed;
+      else
+        ++NumPartialSADFormed;
+    }
+    const ByteSource &Lane = Group.front()->A;
+    const ByteSource &LaneB = Group.front()->B;
+    Intrinsic::ID IID;
+    if (IsProduct && Lane.Width == 2)
+      IID = Lane.IsSigned ? Intrinsic::riscv_biriscv_dmadd16
+                          : Intrinsic::riscv_biriscv_dmadd16u;
+    else if (IsProduct)
+      IID = Lane.IsSigned    ? Intrinsic::riscv_biriscv_dot4
+            : LaneB.IsSigned ? Intrinsic::riscv_biriscv_dot4us
+                             : Intrinsic::riscv_biriscv_dot4u;
+    else
+      IID = Lane.Width == 2 ? Intrinsic::riscv_biriscv_sad16
+            : Lane.IsSigned ? Intrinsic::riscv_biriscv_sads
+                            : Intrinsic::riscv_biriscv_sad;
+    PackedOperands.push_back({PackedA, PackedB, IID});
+  }
 
-  SmallVector<AbsDiffInfo, 4> FoundAbsDiffs;
+  // Terms that did not fit a group are added normally and seed the
+  // accumulator; each SAD, DMADD16 or DOT4 then adds its lanes through rs3
   Value *Accumulator = nullptr;
+  for (AbsDiffInfo *Info : Leftover)
+    OtherAddends.push_back(Info->AbsValue);
+  for (Value *Addend : OtherAddends)
+    Accumulator = Accumulator ? Builder.CreateAdd(Accumulator, Addend) : Addend;
 
-  for (Value *Addend : Addends) {
-    // Try to match absolute difference (both abs() intrinsic and select-based)
+  // If no accumulator found, use zero
+  if (!Accumulator)
+    Accumulator = ConstantInt::get(RootAdd->getType(), 0);
+
+  for (auto [PackedA, PackedB, IID] : PackedOperands) {
+    Function *SADFn =
+        Intrinsic::getOrInsertDeclaration(RootAdd->getModule(), IID);
+    Accumulator = Builder.CreateCall(SADFn, {PackedA, PackedB, Accumulator});
+  }
+
+  RootAdd->replaceAllUsesWith(Accumulator);
+
+  // Clean up the add tree and the byte extractions it no longer needs
+  RecursivelyDeleteTriviallyDeadInstructions(
+      RootAdd, nullptr, nullptr, [this](Value *V) { LeafCache.erase(V); });
+
+  return true;
+}
+
+// The start of Ptr if it walks forward one element of Width bytes per
+// iteration of L, i.e. is the recurrence {Start,+,Width}<L>, or null.
+static const SCEV *getElementStreamStart(ScalarEvolution &SE, Value *Ptr,
+                                         const Loop *L, unsigned Width) {
+  auto *AR = dyn_cast<SCEVAddRecExpr>(SE.getSCEV(Ptr));
+  if (!AR || AR->getLoop() != L || !AR->isAffine())
+    return nullptr;
+
+  auto *Step = dyn_cast<SCEVConstant>(AR->getStepRecurrence(SE));
+  if (!Step || Step->getAPInt() != Width)
+    return nullptr;
+  return AR->getStart();
+}
+
+// Match zext or sext (load i8 P) where P walks forward one byte per iteration
+// of L, i.e. the address is the recurrence {Start,+,1}<L>, or zext (load i16
+// P) where P walks forward one halfword. Width is the element size in bytes
+// and IsSigned is set for sext.
+bool BiRiscVPatternMatcher::matchByteLoadStream(Value *V, const Loop *L,
+                                               const SCEV *&Start,
+                                               unsigned &Width,
+                                               bool &IsSigned) {
+  auto *Ext = dyn_cast<CastInst>(V);
+  if (!Ext || (!isa<ZExtInst>(Ext) && !isa<SExtInst>(Ext)))
+    return false;
+  IsSigned = isa<SExtInst>(Ext);
+
+  auto *Load = dyn_cast<LoadInst>(Ext->getOperand(0));
+  if (!Load || !Load->isSimple() || !L->contains(Load))
+    return false;
+
+  // SAD16 has no signed form
+  if (Load->getType()->isIntegerTy(8))
+    Width = 1;
+  else if (Load->getType()->isIntegerTy(16) && !IsSigned)
+    Width = 2;
+  else
+    return false;
+
+  Start = getElementStreamStart(*SE, Load->getPointerOperand(), L, Width);
+  return Start != nullptr;
+}
+
+// Match a single-block loop of the form:
+//   acc.next = acc + |zext(a[i]) - zext(b[i])|
+// or the same with sext on both loads (int8_t arrays, summed with SADS) or
+// with uint16_t loads (summed with SAD16), or the byte dot product
+//   acc.next = acc + ext(a[i]) * ext(b[i])
+// (summed with DOT4, DOT4U or DOT4US), where every other header phi is an
+// induction variable, the body has no side effects and only acc.next is live
+// out of the loop.
+bool BiRiscVPatternMatcher::matchSADReductionLoop(Loop *L,
+                                                 SADReductionLoop &R) {
+  if (!L->isInnermost() || L->getNumBlocks() != 1 ||
+      !L->isLoopSimplifyForm() ||
+      findStringMetadataForLoop(L, "llvm.loop.riscv.biriscv.sad.epilogue"))
+    return false;
+
+  BasicBlock *Header = L->getHeader();
+  BasicBlock *Exit = L->getExitBlock();
+  auto *Br = dyn_cast<BranchInst>(Header->getTerminator());
+  if (!Exit || !Br || !Br->isConditional())
+    return false;
+
+  // Find the accumulator phi
+  for (PHINode &Phi : Header->phis()) {
+    if (!Phi.getType()->isIntegerTy())
+      continue;
+
+    auto *Next = dyn_cast<Instruction>(Phi.getIncomingValueForBlock(Header));
+    Value *Term;
+    if (!Next || !match(Next, m_c_Add(m_Specific(&Phi), m_Value(Term))) ||
+        !Term->hasOneUse())
+      continue;
+
+    // Accumulators of other widths see the i32 abs-diff through an extend
+    Value *AbsDiff = Term;
+    if (!Phi.getType()->isIntegerTy(32))
+      match(Term, m_ZExtOrSExt(m_Value(AbsDiff)));
+
+    // A product has no abs to look through; its operands may differ in
+    // signedness, the unsigned one then goes to rs1 of DOT4US
     Value *DiffLHS, *DiffRHS;
-    if (matchAbsoluteDifference(Addend, DiffLHS, DiffRHS)) {
-      // Try to match byte extraction on both sides
-      Value *BaseA, *BaseB;
-      unsigned ByteIdxA, ByteIdxB;
-
-      if (matchByteExtraction(DiffLHS, BaseA, ByteIdxA) &&
-          matchByteExtraction(DiffRHS, BaseB, ByteIdxB) &&
-          ByteIdxA == ByteIdxB) {
-        // Found a valid abs(extract(a,i) - extract(b,i))
-        FoundAbsDiffs.push_back({BaseA, BaseB, ByteIdxA, Addend});
+    unsigned WidthA, WidthB;
+    bool SignedA, SignedB;
+    R.IsProduct = !matchAbsoluteDifference(AbsDiff, DiffLHS, DiffRHS);
+    if (R.IsProduct &&
+        !match(AbsDiff, m_Mul(m_Value(DiffLHS), m_Value(DiffRHS))))
+      continue;
+    if (!matchByteLoadStream(DiffLHS, L, R.StartA, WidthA, SignedA) ||
+        !matchByteLoadStream(DiffRHS, L, R.StartB, WidthB, SignedB) ||
+        WidthA != WidthB || (SignedA != SignedB && !R.IsProduct) ||
+        (R.IsProduct && WidthA != 1))
+      continue;
+    if (R.IsProduct && SignedA && !SignedB) {
+      std::swap(R.StartA, R.StartB);
+      std::swap(SignedA, SignedB);
+    }
+    R.Width = WidthA;
+    R.IsSigned = SignedA;
+    R.IsSignedB = SignedB;
+
+    if (!Phi.getType()->isIntegerTy(32)) {
+      ORE->emit([&]() {
+        return OptimizationRemarkMissed(DEBUG_TYPE, "AccNotI32", Next)
+               << (R.IsProduct
+                       ? "byte dot-product loop not converted to DOT4: "
+                       : "byte abs-diff reduction loop not converted to SAD: ")
+               << "accumulator is " << ore::NV("Type", Phi.getType())
+               << ", not i32";
+      });
+      continue;
+    }
+
+    R.AccPhi = &Phi;
+    R.AccNext = Next;
+    break;
+  }
+
+  if (!R.AccPhi)
+    return false;
+
+  // From here on the loop is known to be a byte abs-diff reduction or dot
+  // product, so say why it cannot become a SAD or DOT4 loop
+  auto Missed = [&](StringRef Name, StringRef Reason) {
+    ORE->emit([&]() {
+      return OptimizationRemarkMissed(DEBUG_TYPE, Name, R.AccNext)
+             << (R.IsProduct
+                     ? "byte dot-product loop not converted to DOT4: "
+                     : "byte abs-diff reduction loop not converted to SAD: ")
+             << Reason;
+    });
+    return false;
+  };
+
+  // The remaining phis must be induction variables so the scalar loop can be
+  // resumed at any iteration by rewriting their start values
+  for (PHINode &Phi : Header->phis()) {
+    if (&Phi == R.AccPhi)
+      continue;
+    if (!SE->isSCEVable(Phi.getType()))
+      return Missed("OtherPhi", "loop carries a value that is not an "
+                                "induction variable");
+    auto *AR = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(&Phi));
+    if (!AR || AR->getLoop() != L || !AR->isAffine())
+      return Missed("OtherPhi", "loop carries a value that is not an "
+                                "induction variable");
+  }
+
+  // Skipping iterations is only legal if nothing but the accumulator is
+  // observable outside the loop
+  for (Instruction &I : *Header) {
+    if (I.mayWriteToMemory() || I.mayHaveSideEffects())
+      return Missed("SideEffects", "loop writes memory or has side effects");
+    if (auto *Load = dyn_cast<LoadInst>(&I); Load && !Load->isSimple())
+      return Missed("VolatileLoad", "loop has volatile or atomic loads");
+
+    for (User *U : I.users()) {
+      auto *UI = cast<Instruction>(U);
+      if (L->contains(UI))
         continue;
+      // acc.next may only leave the loop through LCSSA phis in the exit
+      if (&I != R.AccNext || !isa<PHINode>(UI) || UI->getParent() != Exit)
+        return Missed("LiveOut", "a value other than the accumulator is used "
+                                 "after the loop");
+    }
+  }
+
+  // The exit phis must see either acc.next or a loop-invariant value
+  for (PHINode &Phi : Exit->phis()) {
+    Value *V = Phi.getIncomingValueForBlock(Header);
+    if (V != R.AccNext && !L->isLoopInvariant(V))
+      return Missed("LiveOut", "a value other than the accumulator is used "
+                               "after the loop");
+  }
+
+  // One SAD/SADS/DOT4 covers four bytes, one SAD16 two halfwords
+  unsigned LanesPerWord = 4 / R.Width;
+  unsigned ConstTripCount = SE->getSmallConstantTripCount(L);
+  if (ConstTripCount != 0 && ConstTripCount < LanesPerWord)
+    return Missed("ShortTripCount", "trip count is below one word");
+
+  const SCEV *BTC = SE->getBackedgeTakenCount(L);
+  if (isa<SCEVCouldNotCompute>(BTC) ||
+      BTC->getType()->getScalarSizeInBits() > 32)
+    return Missed("UnknownTripCount", "trip count cannot be computed");
+
+  // A trip count that wraps to zero simply leaves everything to the scalar
+  // loop
+  R.TripCount = SE->getTripCountFromExitCount(
+      BTC, Type::getInt32Ty(Header->getContext()), L);
+  return true;
+}
+
+// Emit a SAD (or DOT4) loop in front of L that handles one word (four bytes
+// or two halfwords, S = 2 or 1) per iteration:
+//
+//   preheader:  groups = tc >> S
+//               br (groups != 0 && aligned), sad.body, header
+//   sad.body:   acc = sad(*(u32 *)(a + 4*j), *(u32 *)(b + 4*j), acc)
+//               br (++j == groups), sad.middle, sad.body
+//   sad.middle: br (groups << S == tc), exit, header
+//
+// The original loop is resumed from sad.middle for the remaining 1-3 bytes
+// or single halfword.
+bool BiRiscVPatternMatcher::formSADReductionLoop(Loop *L) {
+  SADReductionLoop R;
+  if (!matchSADReductionLoop(L, R))
+    return false;
+
+  Intrinsic::ID IID;
+  StringRef Name;
+  if (R.IsProduct) {
+    IID = R.IsSigned    ? Intrinsic::riscv_biriscv_dot4
+          : R.IsSignedB ? Intrinsic::riscv_biriscv_dot4us
+                        : Intrinsic::riscv_biriscv_dot4u;
+    Name = R.IsSigned ? "DOT4" : R.IsSignedB ? "DOT4US" : "DOT4U";
+    ++NumDOT4LoopsFormed;
+  } else {
+    IID = R.Width == 2 ? Intrinsic::riscv_biriscv_sad16
+          : R.IsSigned ? Intrinsic::riscv_biriscv_sads
+                       : Intrinsic::riscv_biriscv_sad;
+    Name = R.Width == 2 ? "SAD16" : R.IsSigned ? "SADS" : "SAD";
+    ++NumSADLoopsFormed;
+  }
+
+  LLVM_DEBUG(dbgs() << "BiRiscV: forming " << Name << " loop for "
+                    << *R.AccNext << "\n");
+  ORE->emit([&]() {
+    return OptimizationRemark(DEBUG_TYPE,
+                              R.IsProduct ? "DOT4LoopFormed" : "SADLoopFormed",
+                              R.AccNext)
+           << "formed " << Name << " loop consuming 4 bytes per iteration";
+  });
+
+  BasicBlock *Preheader = L->getLoopPreheader();
+  BasicBlock *Header = L->getHeader();
+  BasicBlock *Exit = L->getExitBlock();
+  Function *F = Header->getParent();
+  LLVMContext &Ctx = F->getContext();
+  Type *I32Ty = Type::getInt32Ty(Ctx);
+
+  SCEVExpander Expander(*SE, *DL, "biriscv.sad");
+  Instruction *PHTerm = Preheader->getTerminator();
+  Value *TripCount = Expander.expandCodeFor(R.TripCount, I32Ty, PHTerm);
+  Value *StartA =
+      Expander.expandCodeFor(R.StartA, R.StartA->getType(), PHTerm);
+  Value *StartB =
+      Expander.expandCodeFor(R.StartB, R.StartB->getType(), PHTerm);
+
+  // log2 of the elements per word
+  unsigned LaneShift = R.Width == 2 ? 1 : 2;
+
+  IRBuilder<> Builder(PHTerm);
+  Value *NumGroups = Builder.CreateLShr(TripCount, LaneShift, "sad.groups");
+  Value *Enter = Builder.CreateICmpNE(NumGroups, Builder.getInt32(0));
+
+  Enter = emitAlignmentChecks(Builder, Enter, {StartA, StartB}, R.AccNext,
+                              R.IsProduct ? "DOT4 loop" : "SAD loop");
+
+  BasicBlock *Body = BasicBlock::Create(Ctx, "sad.body", F, Header);
+  BasicBlock *Middle = BasicBlock::Create(Ctx, "sad.middle", F, Header);
+
+  PHTerm->eraseFromParent();
+  Builder.SetInsertPoint(Preheader);
+  Builder.CreateCondBr(Enter, Body, Header);
+
+  // SAD loop body
+  Builder.SetInsertPoint(Body);
+  PHINode *Idx = Builder.CreatePHI(I32Ty, 2, "sad.idx");
+  PHINode *Acc = Builder.CreatePHI(I32Ty, 2, "sad.acc");
+  Value *Offset = Builder.CreateShl(Idx, 2, "sad.off", /*HasNUW=*/true,
+                                    /*HasNSW=*/true);
+  Value *WordA = Builder.CreateAlignedLoad(
+      I32Ty, Builder.CreateGEP(Builder.getInt8Ty(), StartA, Offset), Align(4));
+  Value *WordB = Builder.CreateAlignedLoad(
+      I32Ty, Builder.CreateGEP(Builder.getInt8Ty(), StartB, Offset), Align(4));
+
+  Function *SADFn = Intrinsic::getOrInsertDeclaration(F->getParent(), IID);
+  Value *SADResult = Builder.CreateCall(SADFn, {WordA, WordB, Acc});
+  Value *IdxNext = Builder.CreateNUWAdd(Idx, Builder.getInt32(1));
+  Builder.CreateCondBr(Builder.CreateICmpEQ(IdxNext, NumGroups), Middle, Body);
+
+  Idx->addIncoming(Builder.getInt32(0), Preheader);
+  Idx->addIncoming(IdxNext, Body);
+  Acc->addIncoming(R.AccPhi->getIncomingValueForBlock(Preheader), Preheader);
+  Acc->addIncoming(SADResult, Body);
+
+  // Middle block: leave directly if no elements remain, otherwise resume the
+  // scalar loop
+  Builder.SetInsertPoint(Middle);
+  Value *Done = Builder.CreateShl(NumGroups, LaneShift, "sad.done", /*HasNUW=*/true,
+                                  /*HasNSW=*/true);
+  Builder.CreateCondBr(Builder.CreateICmpEQ(Done, TripCount), Exit, Header);
+
+  // The original loop is now the scalar epilogue. It is marked so that a
+  // later run (the pass is in both the optimization and the codegen
+  // pipeline) does not put another SAD loop in front of it.
+  finishWordLoop(L, Preheader, Body, Middle, Done, R.AccPhi, SADResult,
+                 "llvm.loop.riscv.biriscv.sad.epilogue");
+  return true;
+}
+
+// Word loads and stores trap on misaligned addresses, so a word loop only
+// runs when all of its streams start on a word boundary. Local buffers get
+// their alignment raised instead, which lets the runtime check fold away.
+// Returns Enter and-ed with the checks that remain.
+Value *BiRiscVPatternMatcher::emitAlignmentChecks(IRBuilder<> &Builder,
+                                                  Value *Enter,
+                                                  ArrayRef<Value *> Starts,
+                                                  const Instruction *RemarkAt,
+                                                  StringRef LoopKind) {
+  Instruction *CxtI = &*Builder.GetInsertPoint();
+  for (Value *Start : Starts) {
+    if (getOrEnforceKnownAlignment(Start, Align(4), *DL, CxtI, nullptr, DT) >=
+        Align(4))
+      continue;
+    ORE->emit([&]() {
+      return OptimizationRemarkAnalysis(DEBUG_TYPE, "RuntimeAlignCheck",
+                                        RemarkAt)
+             << LoopKind << " runs only if " << ore::NV("Pointer", Start)
+             << " is word aligned at run time";
+    });
+    Type *IntPtrTy = DL->getIntPtrType(Start->getType());
+    Value *LowBits = Builder.CreateAnd(Builder.CreatePtrToInt(Start, IntPtrTy),
+                                       ConstantInt::get(IntPtrTy, 3));
+    Enter = Builder.CreateAnd(
+        Enter, Builder.CreateICmpEQ(LowBits, ConstantInt::get(IntPtrTy, 0)));
+  }
+  return Enter;
+}
+
+// Hook the word loop Body, entered from Preheader, and the Middle block it
+// exits to into the dominator tree and loop info, and resume L from Middle
+// after the first Done elements. AccPhi, if any, resumes from AccResult,
+// which the exit phis also see in place of its loop value. L is marked with
+// EpilogueMD so that a later run of the pass leaves the scalar epilogue
+// alone.
+void BiRiscVPatternMatcher::finishWordLoop(Loop *L, BasicBlock *Preheader,
+                                           BasicBlock *Body, BasicBlock *Middle,
+                                           Value *Done, PHINode *AccPhi,
+                                           Value *AccResult,
+                                           StringRef EpilogueMD) {
+  BasicBlock *Header = L->getHeader();
+  BasicBlock *Exit = L->getExitBlock();
+  Value *AccNext =
+      AccPhi ? AccPhi->getIncomingValueForBlock(Header) : nullptr;
+  SCEVExpander Expander(*SE, *DL, "biriscv.resume");
+
+  DomTreeUpdater DTU(DT, DomTreeUpdater::UpdateStrategy::Eager);
+  DTU.applyUpdates({{DominatorTree::Insert, Preheader, Body},
+                    {DominatorTree::Insert, Body, Middle},
+                    {DominatorTree::Insert, Middle, Exit},
+                    {DominatorTree::Insert, Middle, Header}});
+
+  Loop *WordLoop = LI->AllocateLoop();
+  if (Loop *Parent = L->getParentLoop()) {
+    Parent->addChildLoop(WordLoop);
+    Parent->addBasicBlockToLoop(Middle, *LI);
+  } else {
+    LI->addTopLevelLoop(WordLoop);
+  }
+  WordLoop->addBasicBlockToLoop(Body, *LI);
+
+  // Resume values for the scalar loop: each induction variable {S,+,Step}
+  // restarts at S + Done * Step
+  const SCEV *DoneSCEV = SE->getSCEV(Done);
+  SmallVector<std::pair<PHINode *, Value *>, 4> ResumeValues;
+  for (PHINode &Phi : Header->phis()) {
+    if (&Phi == AccPhi) {
+      ResumeValues.push_back({&Phi, AccResult});
+      continue;
+    }
+    auto *AR = cast<SCEVAddRecExpr>(SE->getSCEV(&Phi));
+    const SCEV *Iter = SE->getTruncateOrZeroExtend(
+        DoneSCEV, AR->getStepRecurrence(*SE)->getType());
+    ResumeValues.push_back(
+        {&Phi, Expander.expandCodeFor(AR->evaluateAtIteration(Iter, *SE),
+                                      Phi.getType(),
+                                      Middle->getTerminator())});
+  }
+
+  for (auto &[Phi, Resume] : ResumeValues)
+    Phi->addIncoming(Resume, Middle);
+
+  for (PHINode &Phi : Exit->phis()) {
+    Value *V = Phi.getIncomingValueForBlock(Header);
+    Phi.addIncoming(V == AccNext ? AccResult : V, Middle);
+  }
+
+  addStringMetadataToLoop(L, EpilogueMD);
+  SE->forgetLoop(L);
+}
+
+// SAD accumulates in i32. Point out adds of byte abs-diffs into an
+// accumulator of another width, which are otherwise silently left alone.
+void BiRiscVPatternMatcher::reportNonI32Accumulator(Instruction *Add) {
+  if (!ORE->allowExtraAnalysis(DEBUG_TYPE) || !Add->getType()->isIntegerTy())
+    return;
+
+  // Only report once per chain of such adds
+  if (Add->hasOneUse() && isa<BinaryOperator>(Add->user_back()) &&
+      cast<BinaryOperator>(Add->user_back())->getOpcode() == Instruction::Add)
+    return;
+
+  for (Value *Op : Add->operands()) {
+    Value *AbsDiff;
+    AbsDiffInfo Info;
+    if (match(Op, m_ZExtOrSExt(m_Value(AbsDiff))) &&
+        classifyLeaf(AbsDiff, Info) && !Info.IsProduct) {
+      ORE->emit([&]() {
+        return OptimizationRemarkMissed(DEBUG_TYPE, "AccNotI32", Add)
+               << "byte abs-diffs accumulated in "
+               << ore::NV("Type", Add->getType()) << ", not i32";
+      });
+      return;
+    }
+  }
+}
+
+// The number of independent accumulators that keeps Opcode issuing every
+// cycle: its latency times the number that can issue per cycle, as given by
+// the scheduling model. MADD, DMADD16 and DOT4 (one multiplier, 2 cycles)
+// and SAD (two ALUs, 1 cycle) all need 2 on biriscv.
+unsigned BiRiscVPatternMatcher::getAccumulatorCount(unsigned Opcode) const {
+  if (NumAccumulators)
+    return NumAccumulators;
+
+  const MCSchedModel &SM = ST->getSchedModel();
+  if (!SM.hasInstrSchedModel())
+    return 2;
+  const MCSchedClassDesc *SCDesc =
+      SM.getSchedClassDesc(ST->getInstrInfo()->get(Opcode).getSchedClass());
+  if (!SCDesc->isValid() || SCDesc->isVariant())
+    return 2;
+
+  int Latency = MCSchedModel::computeInstrLatency(*ST, *SCDesc);
+  double RThroughput = MCSchedModel::getReciprocalThroughput(*ST, *SCDesc);
+  if (Latency <= 0 || RThroughput <= 0)
+    return 2;
+  return std::clamp<unsigned>(std::ceil(Latency / RThroughput), 1, 4);
+}
+
+// A product that instruction selection can fuse into a MADD with its user
+static bool isFusibleProduct(const Value *V, const BasicBlock *BB) {
+  auto *Mul = dyn_cast<BinaryOperator>(V);
+  return Mul && Mul->getOpcode() == Instruction::Mul && Mul->hasOneUse() &&
+         Mul->getParent() == BB;
+}
+
+// Is I one step of a MADD accumulation (i32 add of a fusible product) or of a
+// SAD/SADS/DMADD16/DOT4 accumulation? If so, AccIdx is the operand that
+// carries the accumulator.
+static bool isAccumulatorLink(const Instruction *I, bool IsSAD,
+                              unsigned &AccIdx) {
+  if (IsSAD) {
+    AccIdx = 2;
+    return match(I, m_Intrinsic<Intrinsic::riscv_biriscv_sad>()) ||
+           match(I, m_Intrinsic<Intrinsic::riscv_biriscv_sads>()) ||
+           match(I, m_Intrinsic<Intrinsic::riscv_biriscv_sad16>()) ||
+           match(I, m_Intrinsic<Intrinsic::riscv_biriscv_dmadd16>()) ||
+           match(I, m_Intrinsic<Intrinsic::riscv_biriscv_dmadd16u>()) ||
+           match(I, m_Intrinsic<Intrinsic::riscv_biriscv_dot4>()) ||
+           match(I, m_Intrinsic<Intrinsic::riscv_biriscv_dot4u>()) ||
+           match(I, m_Intrinsic<Intrinsic::riscv_biriscv_dot4us>());
+  }
+
+  if (I->getOpcode() != Instruction::Add || !I->getType()->isIntegerTy(32))
+    return false;
+  if (isFusibleProduct(I->getOperand(1), I->getParent()))
+    AccIdx = 0;
+  else if (isFusibleProduct(I->getOperand(0), I->getParent()))
+    AccIdx = 1;
+  else
+    return false;
+  return true;
+}
+
+// The instruction a chain step selects to, for the scheduling model: the
+// rs3 accumulations are SADs unless they are DMADD16s or DOT4s on the
+// multiplier.
+static unsigned getChainOpcode(const Instruction *Link, bool IsSAD) {
+  if (!IsSAD)
+    return RISCV::MADD;
+  if (match(Link, m_Intrinsic<Intrinsic::riscv_biriscv_dmadd16>()) ||
+      match(Link, m_Intrinsic<Intrinsic::riscv_biriscv_dmadd16u>()))
+    return RISCV::DMADD16;
+  if (match(Link, m_Intrinsic<Intrinsic::riscv_biriscv_dot4>()) ||
+      match(Link, m_Intrinsic<Intrinsic::riscv_biriscv_dot4u>()) ||
+      match(Link, m_Intrinsic<Intrinsic::riscv_biriscv_dot4us>()))
+    return RISCV::DOT4;
+  return RISCV::SAD;
+}
+
+// Split the serial chain Links (in program order) into independent
+// accumulators that are summed after its last step:
+//
+//   a1 = madd(x1, acc)        a1 = madd(x1, acc)
+//   a2 = madd(x2, a1)   -->   b2 = mul(x2)
+//   a3 = madd(x3, a2)         a3 = madd(x3, a1)
+//   a4 = madd(x4, a3)         b4 = madd(x4, b2)
+//                             a4' = a3 + b4
+//
+// The adds wrap, so this is exact for any grouping.
+bool BiRiscVPatternMatcher::splitAccumulatorChain(ArrayRef<Instruction *> Links,
+                                                  bool IsSAD) {
+  unsigned Opcode = getChainOpcode(Links.back(), IsSAD);
+  unsigned NumAcc = getAccumulatorCount(Opcode);
+  // Every accumulator takes at least two steps, otherwise the final adds
+  // cost more than they save
+  NumAcc = std::min<unsigned>(NumAcc, Links.size() / 2);
+  if (NumAcc < 2)
+    return false;
+
+  Instruction *Tail = Links.back();
+  SmallVector<Use *, 4> TailUses;
+  for (Use &U : Tail->uses())
+    TailUses.push_back(&U);
+
+  LLVMContext &Ctx = Tail->getContext();
+  MDNode *SplitMD = MDNode::get(Ctx, {});
+
+  // Deal the steps round-robin to the accumulators. The first accumulator
+  // continues from the original start value, the others start from zero.
+  SmallVector<Value *, 4> Accs(NumAcc, nullptr);
+  SmallVector<Instruction *, 4> Dead;
+  for (auto [Idx, Link] : enumerate(Links)) {
+    unsigned AccIdx;
+    isAccumulatorLink(Link, IsSAD, AccIdx);
+    Link->setMetadata(AccSplitMDName, SplitMD);
+    Link->dropPoisonGeneratingFlags();
+
+    Value *&Acc = Accs[Idx % NumAcc];
+    if (Idx == 0) {
+      Acc = Link;
+    } else if (Idx < NumAcc && !IsSAD) {
+      // madd(x, 0) is just the product
+      Acc = Link->getOperand(1 - AccIdx);
+      Dead.push_back(Link);
+    } else {
+      if (!Acc)
+        Acc = ConstantInt::get(Link->getType(), 0);
+      Link->setOperand(AccIdx, Acc);
+      Acc = Link;
+    }
+  }
+
+  IRBuilder<> Builder(Tail->getNextNode());
+  while (Accs.size() > 1) {
+    SmallVector<Value *, 4> Sums;
+    for (unsigned I = 0; I + 1 < Accs.size(); I += 2) {
+      auto *Sum = cast<Instruction>(
+          Builder.CreateAdd(Accs[I], Accs[I + 1], "acc.sum"));
+      Sum->setMetadata(AccSplitMDName, SplitMD);
+      Sums.push_back(Sum);
+    }
+    if (Accs.size() % 2)
+      Sums.push_back(Accs.back());
+    Accs = std::move(Sums);
+  }
+
+  for (Use *U : TailUses)
+    U->set(Accs.front());
+  for (Instruction *I : reverse(Dead))
+    I->eraseFromParent();
+
+  ++NumAccChainsSplit;
+  ORE->emit([&]() {
+    return OptimizationRemark(DEBUG_TYPE, "AccumulatorsSplit", Tail)
+           << "split chain of " << ore::NV("Length", Links.size()) << " "
+           << (Opcode == RISCV::MADD      ? "MADD"
+               : Opcode == RISCV::DMADD16 ? "DMADD16"
+               : Opcode == RISCV::DOT4    ? "DOT4"
+                                          : "SAD")
+           << "s into "
+           << ore::NV("NumAccumulators", NumAcc) << " accumulators";
+  });
+  return true;
+}
+
+bool BiRiscVPatternMatcher::splitAccumulatorChains(Function &Fn) {
+  if (NumAccumulators == 1)
+    return false;
+
+  // Find each chain from its last step. A step whose only user continues the
+  // chain in the same block is not the last one.
+  SmallVector<std::pair<SmallVector<Instruction *, 16>, bool>, 4> Chains;
+  for (BasicBlock &BB : Fn) {
+    for (Instruction &I : BB) {
+      for (bool IsSAD : {false, true}) {
+        unsigned AccIdx, UserAccIdx;
+        if (!isAccumulatorLink(&I, IsSAD, AccIdx) ||
+            I.getMetadata(AccSplitMDName))
+          continue;
+        if (I.hasOneUse()) {
+          auto *User = cast<Instruction>(I.user_back());
+          if (User->getParent() == &BB &&
+              isAccumulatorLink(User, IsSAD, UserAccIdx) &&
+              User->getOperand(UserAccIdx) == &I)
+            continue;
+        }
+
+        SmallVector<Instruction *, 16> Links = {&I};
+        while (true) {
+          auto *Prev = dyn_cast<Instruction>(Links.back()->getOperand(AccIdx));
+          if (!Prev || Prev->getParent() != &BB || !Prev->hasOneUse() ||
+              Prev->getMetadata(AccSplitMDName) ||
+              !isAccumulatorLink(Prev, IsSAD, AccIdx))
+            break;
+          Links.push_back(Prev);
+        }
+        std::reverse(Links.begin(), Links.end());
+        Chains.push_back({std::move(Links), IsSAD});
       }
     }
+  }
+
+  bool MadeChange = false;
+  for (auto &[Links, IsSAD] : Chains)
+    if (splitAccumulatorChain(Links, IsSAD))
+      MadeChange = true;
+  return MadeChange;
+}
+
+// The packed instruction computing I, and its two operands. I is a <4 x i8>
+// or <2 x i16> operation or, in the body of a loop that formPackedMapLoop
+// widens, the i8 or i16 operation on one element. Halfword lanes only have
+// ADD16/SUB16.
+static Intrinsic::ID matchPackedOp(Instruction &I, Value *&A, Value *&B) {
+  Type *Ty = I.getType();
+  if (auto *VTy = dyn_cast<FixedVectorType>(Ty);
+      VTy && VTy->getPrimitiveSizeInBits().getFixedValue() != 32)
+    return Intrinsic::not_intrinsic;
+  bool IsHalf = Ty->getScalarType()->isIntegerTy(16);
+  if (!IsHalf && !Ty->getScalarType()->isIntegerTy(8))
+    return Intrinsic::not_intrinsic;
+
+  if (match(&I, m_Add(m_Value(A), m_Value(B))))
+    return IsHalf ? Intrinsic::riscv_biriscv_add16
+                  : Intrinsic::riscv_biriscv_add_b;
+  if (match(&I, m_Sub(m_Value(A), m_Value(B))))
+    return IsHalf ? Intrinsic::riscv_biriscv_sub16
+                  : Intrinsic::riscv_biriscv_sub_b;
+  if (IsHalf)
+    return Intrinsic::not_intrinsic;
+
+  if (match(&I, m_Intrinsic<Intrinsic::uadd_sat>(m_Value(A), m_Value(B))))
+    return Intrinsic::riscv_biriscv_addus_b;
+  if (match(&I, m_Intrinsic<Intrinsic::usub_sat>(m_Value(A), m_Value(B))))
+    return Intrinsic::riscv_biriscv_subus_b;
+  if (match(&I, m_UMin(m_Value(A), m_Value(B))))
+    return Intrinsic::riscv_biriscv_minu_b;
+  if (match(&I, m_UMax(m_Value(A), m_Value(B))))
+    return Intrinsic::riscv_biriscv_maxu_b;
+
+  // Rounding average, computed in wider lanes so that a + b + 1 cannot wrap:
+  // trunc((zext(a) + zext(b) + 1) >> 1), the adds in either order
+  Value *Sum;
+  if (match(&I, m_Trunc(m_LShr(m_Value(Sum), m_One()))) &&
+      (match(Sum, m_c_Add(m_c_Add(m_ZExt(m_Value(A)), m_ZExt(m_Value(B))),
+                          m_One())) ||
+       match(Sum, m_c_Add(m_c_Add(m_ZExt(m_Value(A)), m_One()),
+                          m_ZExt(m_Value(B))))) &&
+      A->getType() == Ty && B->getType() == Ty &&
+      Sum->getType()->getScalarSizeInBits() > 8)
+    return Intrinsic::riscv_biriscv_avgu_b;
+
+  return Intrinsic::not_intrinsic;
+}
+
+// vector.reduce.add(mul(ext(a), ext(b))) of <4 x i8> a and b: the DOT4,
+// DOT4U or DOT4US of the two words. Each product, and so the sum, is exact
+// modulo 2^N in N-bit lanes, as in the i32 result truncated to N bits.
+static Intrinsic::ID matchPackedDotReduction(Instruction &I, Value *&A,
+                                             Value *&B) {
+  Value *Prod;
+  if (!match(&I, m_Intrinsic<Intrinsic::vector_reduce_add>(m_Value(Prod))))
+    return Intrinsic::not_intrinsic;
+
+  bool SignedA, SignedB;
+  if (match(Prod, m_Mul(m_SExt(m_Value(A)), m_SExt(m_Value(B)))))
+    SignedA = SignedB = true;
+  else if (match(Prod, m_Mul(m_ZExt(m_Value(A)), m_ZExt(m_Value(B)))))
+    SignedA = SignedB = false;
+  else if (match(Prod, m_c_Mul(m_ZExt(m_Value(A)), m_SExt(m_Value(B))))) {
+    SignedA = false;
+    SignedB = true;
+  } else
+    return Intrinsic::not_intrinsic;
+
+  auto *VTy = dyn_cast<FixedVectorType>(A->getType());
+  unsigned Bits = Prod->getType()->getScalarSizeInBits();
+  if (!VTy || B->getType() != VTy || VTy->getNumElements() != 4 ||
+      !VTy->getElementType()->isIntegerTy(8) || Bits > 32)
+    return Intrinsic::not_intrinsic;
+  return SignedA   ? Intrinsic::riscv_biriscv_dot4
+         : SignedB ? Intrinsic::riscv_biriscv_dot4us
+                   : Intrinsic::riscv_biriscv_dot4u;
+}
 
-    // If not an abs-diff, could be the accumulator
-    if (!Accumulator)
-      Accumulator = Addend;
+// vector.reduce.add(abs(sub(ext(a), ext(b)))) of <4 x i8> a and b, or of
+// zero-extended <2 x i16>: the SAD, SADS or SAD16 of the two words. Byte dot
+// products go to matchPackedDotReduction.
+static Intrinsic::ID matchPackedReduction(Instruction &I, Value *&A,
+                                          Value *&B) {
+  Value *Diff;
+  if (!match(&I, m_Intrinsic<Intrinsic::vector_reduce_add>(
+                     m_Intrinsic<Intrinsic::abs>(m_Value(Diff), m_Value()))))
+    return matchPackedDotReduction(I, A, B);
+
+  bool IsSigned = match(Diff, m_Sub(m_SExt(m_Value(A)), m_SExt(m_Value(B))));
+  if (!IsSigned &&
+      !match(Diff, m_Sub(m_ZExt(m_Value(A)), m_ZExt(m_Value(B)))))
+    return Intrinsic::not_intrinsic;
+
+  // One bit more than the elements is enough for their difference to be
+  // exact; the sum wraps like the i32 SAD result truncated to it
+  auto *VTy = dyn_cast<FixedVectorType>(A->getType());
+  if (!VTy || B->getType() != VTy ||
+      Diff->getType()->getScalarSizeInBits() <= VTy->getScalarSizeInBits())
+    return Intrinsic::not_intrinsic;
+
+  if (VTy->getNumElements() == 4 && VTy->getElementType()->isIntegerTy(8))
+    return IsSigned ? Intrinsic::riscv_biriscv_sads
+                    : Intrinsic::riscv_biriscv_sad;
+  if (VTy->getNumElements() == 2 && VTy->getElementType()->isIntegerTy(16) &&
+      !IsSigned)
+    return Intrinsic::riscv_biriscv_sad16;
+  return Intrinsic::not_intrinsic;
+}
+
+// Rewrite the <4 x i8> and <2 x i16> operations that one packed instruction
+// computes into its intrinsic on the i32 holding the lanes: element-wise
+// operations (uint8x4_t code) and abs-diff and dot-product reductions
+// (clang's __builtin_reduce_add, the SLP vectorizer). Neither type is legal, so
+// instruction selection would otherwise take the vectors apart into scalar
+// lane operations. Loads and stores stay as they are: the DAG combiner folds
+// them and the bitcasts into i32 loads and stores.
+bool BiRiscVPatternMatcher::lowerPackedVectorOps(Function &Fn) {
+  SmallVector<Instruction *, 8> Ops;
+  for (Instruction &I : instructions(Fn)) {
+    Value *A, *B;
+    if ((isa<FixedVectorType>(I.getType()) &&
+         matchPackedOp(I, A, B) != Intrinsic::not_intrinsic) ||
+        matchPackedReduction(I, A, B) != Intrinsic::not_intrinsic)
+      Ops.push_back(&I);
+  }
+
+  Type *I32Ty = Type::getInt32Ty(Fn.getContext());
+  // Operands that are the result of another packed instruction are used as
+  // the i32 directly, not bitcast back and forth
+  auto AsWord = [&](IRBuilder<> &Builder, Value *V) -> Value * {
+    Value *Word;
+    if (match(V, m_BitCast(m_Value(Word))) && Word->getType() == I32Ty)
+      return Word;
+    return Builder.CreateBitCast(V, I32Ty);
+  };
+
+  SmallVector<WeakTrackingVH, 8> MaybeDead;
+  for (Instruction *I : Ops) {
+    // Matched again since the operands may have been rewritten in the
+    // meantime
+    Value *A, *B;
+    Intrinsic::ID IID = matchPackedReduction(*I, A, B);
+    bool IsReduction = IID != Intrinsic::not_intrinsic;
+    if (!IsReduction)
+      IID = matchPackedOp(*I, A, B);
+
+    IRBuilder<> Builder(I);
+    SmallVector<Value *, 3> Args = {AsWord(Builder, A), AsWord(Builder, B)};
+    if (IsReduction)
+      Args.push_back(Builder.getInt32(0));
+    Value *Word = Builder.CreateIntrinsic(IID, {}, Args);
+    // The SADs are never negative; a dot product is only ever truncated
+    I->replaceAllUsesWith(IsReduction
+                              ? Builder.CreateZExtOrTrunc(Word, I->getType())
+                              : Builder.CreateBitCast(Word, I->getType()));
+    LLVM_DEBUG(dbgs() << "BiRiscV: " << *I << " -> " << *Word << "\n");
+    // The widened average and the reduction leave extends, adds and the abs
+    // behind
+    for (Value *Op : I->operands())
+      MaybeDead.push_back(Op);
+    I->eraseFromParent();
+    ++NumPackedOps;
   }
+  RecursivelyDeleteTriviallyDeadInstructionsPermissive(MaybeDead);
 
-  // We need exactly 4 byte absolute differences
-  if (FoundAbsDiffs.size() != 4)
+  return !Ops.empty();
+}
+
+// Match V, a value of the element type of R.Store, as a tree of packed
+// operations whose leaves are elements of arrays walked in step with dst
+// (collected in R.Loads) or loop-invariant values.
+bool BiRiscVPatternMatcher::matchPackedMapExpr(Value *V, const Loop *L,
+                                               PackedMapLoop &R,
+                                               unsigned Depth) {
+  if (V->getType() != R.Store->getValueOperand()->getType())
     return false;
+  if (L->isLoopInvariant(V))
+    return true;
 
-  // Verify all 4 bytes are covered (0, 1, 2, 3)
-  bool BytesSeen[4] = {false, false, false, false};
-  for (const auto &Info : FoundAbsDiffs) {
-    if (Info.ByteIndex >= 4)
+  if (auto *Load = dyn_cast<LoadInst>(V)) {
+    if (!Load->isSimple() || !L->contains(Load) ||
+        !getElementStreamStart(*SE, Load->getPointerOperand(), L, R.Width))
       return false;
-    BytesSeen[Info.ByteIndex] = true;
+    if (!is_contained(R.Loads, Load))
+      R.Loads.push_back(Load);
+    return true;
   }
 
-  if (!BytesSeen[0] || !BytesSeen[1] || !BytesSeen[2] || !BytesSeen[3])
+  auto *I = dyn_cast<Instruction>(V);
+  Value *A, *B;
+  if (!I || Depth >= MaxPackedMapDepth ||
+      matchPackedOp(*I, A, B) == Intrinsic::not_intrinsic)
+    return false;
+  if (is_contained(R.Ops, I))
+    return true;
+  if (!matchPackedMapExpr(A, L, R, Depth + 1) ||
+      !matchPackedMapExpr(B, L, R, Depth + 1))
+    return false;
+  R.Ops.push_back(I);
+  return true;
+}
+
+// Match a single-block loop of the form:
+//   dst[i] = f(a[i], b[i], ...)
+// over uint8_t or uint16_t arrays, where f is made of operations that packed
+// instructions implement (see matchPackedOp) and may also use loop-invariant
+// values. The store must be the only side effect, every other header phi an
+// induction variable and nothing may be live out of the loop.
+bool BiRiscVPatternMatcher::matchPackedMapLoop(Loop *L, PackedMapLoop &R) {
+  if (!L->isInnermost() || L->getNumBlocks() != 1 ||
+      !L->isLoopSimplifyForm() ||
+      findStringMetadataForLoop(L, "llvm.loop.riscv.biriscv.packed.epilogue"))
     return false;
 
-  // Verify all diffs use the same base values
-  Value *BaseA = FoundAbsDiffs[0].BaseA;
-  Value *BaseB = FoundAbsDiffs[0].BaseB;
-  for (const auto &Info : FoundAbsDiffs) {
-    if (Info.BaseA != BaseA || Info.BaseB != BaseB)
+  BasicBlock *Header = L->getHeader();
+  BasicBlock *Exit = L->getExitBlock();
+  auto *Br = dyn_cast<BranchInst>(Header->getTerminator());
+  if (!Exit || !Br || !Br->isConditional())
+    return false;
+
+  for (Instruction &I : *Header) {
+    auto *Store = dyn_cast<StoreInst>(&I);
+    if (!Store)
+      continue;
+    if (R.Store)
       return false;
+    R.Store = Store;
   }
+  if (!R.Store || !R.Store->isSimple())
+    return false;
 
-  // If no accumulator found, use zero
-  if (!Accumulator)
-    Accumulator = ConstantInt::get(RootAdd->getType(), 0);
+  Type *EltTy = R.Store->getValueOperand()->getType();
+  if (!EltTy->isIntegerTy(8) && !EltTy->isIntegerTy(16))
+    return false;
+  R.Width = EltTy->getIntegerBitWidth() / 8;
+  R.StartD =
+      getElementStreamStart(*SE, R.Store->getPointerOperand(), L, R.Width);
+  if (!R.StartD || !matchPackedMapExpr(R.Store->getValueOperand(), L, R) ||
+      R.Ops.empty() || R.Loads.empty())
+    return false;
 
-  // SUCCESS! Replace with SAD intrinsic
-  IRBuilder<> Builder(RootAdd);
+  // From here on the loop is known to compute dst element-wise, so say why it
+  // cannot use the packed instructions
+  auto Missed = [&](StringRef Name, StringRef Reason) {
+    ORE->emit([&]() {
+      return OptimizationRemarkMissed(DEBUG_TYPE, Name, R.Store)
+             << "element-wise " << (R.Width == 2 ? "halfword" : "byte")
+             << " loop not converted to packed instructions: " << Reason;
+    });
+    return false;
+  };
 
-  Function *SADFn = Intrinsic::getOrInsertDeclaration(
-      RootAdd->getModule(), Intrinsic::riscv_biriscv_sad);
+  // The remaining phis must be induction variables so the scalar loop can be
+  // resumed at any iteration by rewriting their start values
+  for (PHINode &Phi : Header->phis()) {
+    auto *AR = SE->isSCEVable(Phi.getType())
+                   ? dyn_cast<SCEVAddRecExpr>(SE->getSCEV(&Phi))
+                   : nullptr;
+    if (!AR || AR->getLoop() != L || !AR->isAffine())
+      return Missed("OtherPhi", "loop carries a value that is not an "
+                                "induction variable");
+  }
 
-  // Check if BaseA and BaseB are pointers (memory load case)
-  // If so, we need to load and pack the bytes first
-  Value *PackedA = BaseA;
-  Value *PackedB = BaseB;
+  for (Instruction &I : *Header) {
+    if (&I != R.Store && (I.mayWriteToMemory() || I.mayHaveSideEffects()))
+      return Missed("SideEffects", "loop has side effects besides the store");
+    if (auto *Load = dyn_cast<LoadInst>(&I); Load && !Load->isSimple())
+      return Missed("VolatileLoad", "loop has volatile or atomic loads");
+    for (User *U : I.users())
+      if (!L->contains(cast<Instruction>(U)))
+        return Missed("LiveOut", "a value computed in the loop is used after "
+                                 "the loop");
+  }
 
-  if (BaseA->getType()->isPointerTy()) {
-    // Memory load case: load 4 bytes and pack them into i32
-    // Create loads for each byte
-    SmallVector<Value *, 4> BytesA, BytesB;
+  // One word holds four bytes or two halfwords
+  unsigned LanesPerWord = 4 / R.Width;
+  unsigned ConstTripCount = SE->getSmallConstantTripCount(L);
+  if (ConstTripCount != 0 && ConstTripCount < LanesPerWord)
+    return Missed("ShortTripCount", "trip count is below one word");
 
-    for (unsigned i = 0; i < 4; i++) {
-      // Create GEP for offset i
-      Value *PtrA = Builder.CreateConstGEP1_32(Builder.getInt8Ty(), BaseA, i);
-      Value *PtrB = Builder.CreateConstGEP1_32(Builder.getInt8Ty(), BaseB, i);
+  const SCEV *BTC = SE->getBackedgeTakenCount(L);
+  if (isa<SCEVCouldNotCompute>(BTC) ||
+      BTC->getType()->getScalarSizeInBits() > 32)
+    return Missed("UnknownTripCount", "trip count cannot be computed");
 
-      // Load the bytes
-      Value *ByteA = Builder.CreateLoad(Builder.getInt8Ty(), PtrA);
-      Value *ByteB = Builder.CreateLoad(Builder.getInt8Ty(), PtrB);
+  R.TripCount = SE->getTripCountFromExitCount(
+      BTC, Type::getInt32Ty(Header->getContext()), L);
+  return true;
+}
 
-      // Zero-extend to i32
-      BytesA.push_back(Builder.CreateZExt(ByteA, Builder.getInt32Ty()));
-      BytesB.push_back(Builder.CreateZExt(ByteB, Builder.getInt32Ty()));
-    }
+// Emit a loop in front of L that computes one word of dst (four bytes or two
+// halfwords, S = 2 or 1) per iteration:
+//
+//   preheader:     words = tc >> S
+//                  br (words != 0 && aligned && no overlap), packed.body,
+//                     header
+//   packed.body:   *(u32 *)(dst + 4*j) = f'(*(u32 *)(a + 4*j), ...)
+//                  br (++j == words), packed.middle, packed.body
+//   packed.middle: br (words << S == tc), exit, header
+//
+// f' is f with each operation replaced by its packed instruction and each
+// loop-invariant operand splatted across the word. The original loop is
+// resumed from packed.middle for the remaining elements. dst may be one of
+// the source arrays, since every word is read before it is written, but must
+// not overlap one otherwise; this is checked at run time.
+bool BiRiscVPatternMatcher::formPackedMapLoop(Loop *L) {
+  PackedMapLoop R;
+  if (!matchPackedMapLoop(L, R))
+    return false;
+
+  LLVM_DEBUG(dbgs() << "BiRiscV: forming packed loop for " << *R.Store
+                    << "\n");
+  ORE->emit([&]() {
+    return OptimizationRemark(DEBUG_TYPE, "PackedLoopFormed", R.Store)
+           << "formed packed loop computing a word of "
+           << (R.Width == 2 ? "halfwords" : "bytes") << " with "
+           << ore::NV("NumOps", unsigned(R.Ops.size()))
+           << " instruction(s) per iteration";
+  });
+  ++NumPackedLoopsFormed;
+
+  BasicBlock *Preheader = L->getLoopPreheader();
+  BasicBlock *Header = L->getHeader();
+  BasicBlock *Exit = L->getExitBlock();
+  Function *F = Header->getParent();
+  LLVMContext &Ctx = F->getContext();
+  Type *I32Ty = Type::getInt32Ty(Ctx);
+
+  SCEVExpander Expander(*SE, *DL, "biriscv.packed");
+  Instruction *PHTerm = Preheader->getTerminator();
+  Value *TripCount = Expander.expandCodeFor(R.TripCount, I32Ty, PHTerm);
+  Value *StartD =
+      Expander.expandCodeFor(R.StartD, R.StartD->getType(), PHTerm);
+  DenseMap<LoadInst *, Value *> LoadStarts;
+  SmallVector<Value *, 4> Starts = {StartD};
+  for (LoadInst *Load : R.Loads) {
+    const SCEV *S =
+        getElementStreamStart(*SE, Load->getPointerOperand(), L, R.Width);
+    Value *Start = Expander.expandCodeFor(S, S->getType(), PHTerm);
+    LoadStarts[Load] = Start;
+    if (!is_contained(Starts, Start))
+      Starts.push_back(Start);
+  }
 
-    // Pack bytes into i32: (byte3 << 24) | (byte2 << 16) | (byte1 << 8) | byte0
-    PackedA = BytesA[0];
-    PackedB = BytesB[0];
+  // log2 of the elements per word
+  unsigned LaneShift = R.Width == 2 ? 1 : 2;
+
+  IRBuilder<> Builder(PHTerm);
+  Value *NumWords = Builder.CreateLShr(TripCount, LaneShift, "packed.words");
+  Value *Enter = Builder.CreateICmpNE(NumWords, Builder.getInt32(0));
+  Enter = emitAlignmentChecks(Builder, Enter, Starts, R.Store, "packed loop");
+
+  // A source array that overlaps dst without being dst would be read after
+  // the scalar loop had already written to it
+  Type *IntPtrTy = DL->getIntPtrType(StartD->getType());
+  Value *Bytes = Builder.CreateShl(
+      Builder.CreateZExtOrTrunc(TripCount, IntPtrTy), R.Width - 1);
+  Value *DstBegin = Builder.CreatePtrToInt(StartD, IntPtrTy);
+  Value *DstEnd = Builder.CreateAdd(DstBegin, Bytes);
+  for (Value *Start : drop_begin(Starts)) {
+    ORE->emit([&]() {
+      return OptimizationRemarkAnalysis(DEBUG_TYPE, "RuntimeAliasCheck",
+                                        R.Store)
+             << "packed loop runs only if " << ore::NV("Pointer", Start)
+             << " is the destination or does not overlap it";
+    });
+    Value *SrcBegin = Builder.CreatePtrToInt(Start, IntPtrTy);
+    Value *SrcEnd = Builder.CreateAdd(SrcBegin, Bytes);
+    Value *NoAlias = Builder.CreateOr(
+        Builder.CreateICmpEQ(SrcBegin, DstBegin),
+        Builder.CreateOr(Builder.CreateICmpULE(DstEnd, SrcBegin),
+                         Builder.CreateICmpULE(SrcEnd, DstBegin)));
+    Enter = Builder.CreateAnd(Enter, NoAlias);
+  }
 
-    for (unsigned i = 1; i < 4; i++) {
-      Value *ShiftedA = Builder.CreateShl(BytesA[i], i * 8);
-      Value *ShiftedB = Builder.CreateShl(BytesB[i], i * 8);
-      PackedA = Builder.CreateOr(PackedA, ShiftedA);
-      PackedB = Builder.CreateOr(PackedB, ShiftedB);
-    }
+  // Loop-invariant operands, splatted across the word
+  DenseMap<Value *, Value *> Words;
+  Constant *SplatMul = Builder.getInt32(R.Width == 2 ? 0x00010001 : 0x01010101);
+  for (Instruction *I : R.Ops) {
+    Value *A, *B;
+    matchPackedOp(*I, A, B);
+    for (Value *Op : {A, B})
+      if (L->isLoopInvariant(Op) && !Words.count(Op))
+        Words[Op] = Builder.CreateMul(Builder.CreateZExt(Op, I32Ty), SplatMul,
+                                      "packed.splat");
   }
 
-  Value *SADResult = Builder.CreateCall(SADFn, {PackedA, PackedB, Accumulator});
+  BasicBlock *Body = BasicBlock::Create(Ctx, "packed.body", F, Header);
+  BasicBlock *Middle = BasicBlock::Create(Ctx, "packed.middle", F, Header);
+
+  PHTerm->eraseFromParent();
+  Builder.SetInsertPoint(Preheader);
+  Builder.CreateCondBr(Enter, Body, Header);
+
+  // Packed loop body: the operations of f in order, on whole words
+  Builder.SetInsertPoint(Body);
+  PHINode *Idx = Builder.CreatePHI(I32Ty, 2, "packed.idx");
+  Value *Offset = Builder.CreateShl(Idx, 2, "packed.off", /*HasNUW=*/true,
+                                    /*HasNSW=*/true);
+  for (LoadInst *Load : R.Loads)
+    Words[Load] = Builder.CreateAlignedLoad(
+        I32Ty,
+        Builder.CreateGEP(Builder.getInt8Ty(), LoadStarts[Load], Offset),
+        Align(4));
+  for (Instruction *I : R.Ops) {
+    Value *A, *B;
+    Intrinsic::ID IID = matchPackedOp(*I, A, B);
+    Words[I] = Builder.CreateIntrinsic(IID, {}, {Words[A], Words[B]});
+  }
+  Builder.CreateAlignedStore(
+      Words[R.Store->getValueOperand()],
+      Builder.CreateGEP(Builder.getInt8Ty(), StartD, Offset), Align(4));
+  Value *IdxNext = Builder.CreateNUWAdd(Idx, Builder.getInt32(1));
+  Builder.CreateCondBr(Builder.CreateICmpEQ(IdxNext, NumWords), Middle, Body);
+
+  Idx->addIncoming(Builder.getInt32(0), Preheader);
+  Idx->addIncoming(IdxNext, Body);
+
+  // Middle block: leave directly if no elements remain, otherwise resume the
+  // scalar loop
+  Builder.SetInsertPoint(Middle);
+  Value *Done = Builder.CreateShl(NumWords, LaneShift, "packed.done",
+                                  /*HasNUW=*/true, /*HasNSW=*/true);
+  Builder.CreateCondBr(Builder.CreateICmpEQ(Done, TripCount), Exit, Header);
+
+  finishWordLoop(L, Preheader, Body, Middle, Done, /*AccPhi=*/nullptr,
+                 /*AccResult=*/nullptr,
+                 "llvm.loop.riscv.biriscv.packed.epilogue");
+  return true;
+}
+
+bool BiRiscVPatternMatcher::run(Function &Fn) {
+  bool MadeChange = false;
 
-  RootAdd->replaceAllUsesWith(SADResult);
+  // Form SAD loops first; the straight-line matcher below then only sees
+  // what is left. Collect the loops up front since new ones get added.
+  SmallVector<Loop *, 8> InnerLoops;
+  for (Loop *L : LI->getLoopsInPreorder())
+    if (L->isInnermost())
+      InnerLoops.push_back(L);
+
+  for (Loop *L : InnerLoops)
+    if (formSADReductionLoop(L) || formPackedMapLoop(L))
+      MadeChange = true;
+
+  // Find the reduction-tree roots up front and analyze each tree once from
+  // its root. Roots that an earlier replacement deleted are skipped.
+  SmallVector<WeakVH, 16> Roots;
+  for (Instruction &I : instructions(Fn)) {
+    if (isReductionAdd(&I) && !isInteriorAdd(&I))
+      Roots.push_back(&I);
+    else if (I.getOpcode() == Instruction::Add && !I.getType()->isIntegerTy(32))
+      reportNonI32Accumulator(&I);
+  }
 
-  // Clean up dead instructions
-  for (auto *Inst : AddChain) {
-    if (Inst->use_empty() && Inst != RootAdd)
-      Inst->eraseFromParent();
+  LeafCache.clear();
+  for (WeakVH &Root : Roots) {
+    if (auto *RootAdd = dyn_cast_or_null<Instruction>(Root))
+      if (trySADReplacement(RootAdd))
+        MadeChange = true;
   }
+  LeafCache.clear();
 
-  if (RootAdd->use_empty())
-    RootAdd->eraseFromParent();
+  if (lowerPackedVectorOps(Fn))
+    MadeChange = true;
 
-  return true;
+  // Split the MADD/SAD accumulation chains last, including the SAD chains
+  // formed above
+  if (splitAccumulatorChains(Fn))
+    MadeChange = true;
+
+  return MadeChange;
 }
 
 bool RISCVBiRiscVPatterns::runOnFunction(Function &Fn) {
@@ -394,24 +2303,39 @@ bool RISCVBiRiscVPatterns::runOnFunction(Function &Fn) {
 
   auto &TPC = getAnalysis<TargetPassConfig>();
   auto &TM = TPC.getTM<RISCVTargetMachine>();
-  ST = &TM.getSubtarget<RISCVSubtarget>(Fn);
-  DL = &Fn.getDataLayout();
 
   // Check if BiRiscV extension is enabled
-  if (!ST->hasStdExtXBiRiscV())
+  const auto &ST = TM.getSubtarget<RISCVSubtarget>(Fn);
+  if (!ST.hasStdExtXBiRiscV())
     return false;
 
-  bool MadeChange = false;
+  auto &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+  auto &SE = getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+  auto &DT = getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+  auto &ORE = getAnalysis<OptimizationRemarkEmitterWrapperPass>().getORE();
 
-  // Walk through all instructions looking for patterns
-  for (BasicBlock &BB : Fn) {
-    for (Instruction &I : make_early_inc_range(BB)) {
-      if (auto *Add = dyn_cast<BinaryOperator>(&I)) {
-        if (trySADReplacement(Add))
-          MadeChange = true;
-      }
-    }
-  }
+  return BiRiscVPatternMatcher(ST, Fn.getDataLayout(), LI, SE, DT, ORE)
+      .run(Fn);
+}
 
-  return MadeChange;
+PreservedAnalyses RISCVBiRiscVPatternsPass::run(Function &Fn,
+                                                FunctionAnalysisManager &FAM) {
+  const auto &ST = TM->getSubtarget<RISCVSubtarget>(Fn);
+  if (!ST.hasStdExtXBiRiscV())
+    return PreservedAnalyses::all();
+
+  auto &LI = FAM.getResult<LoopAnalysis>(Fn);
+  auto &SE = FAM.getResult<ScalarEvolutionAnalysis>(Fn);
+  auto &DT = FAM.getResult<DominatorTreeAnalysis>(Fn);
+  auto &ORE = FAM.getResult<OptimizationRemarkEmitterAnalysis>(Fn);
+
+  if (!BiRiscVPatternMatcher(ST, Fn.getDataLayout(), LI, SE, DT, ORE).run(Fn))
+    return PreservedAnalyses::all();
+
+  // New SAD loops are added to the dominator tree and loop info as they are
+  // formed
+  PreservedAnalyses PA;
+  PA.preserve<DominatorTreeAnalysis>();
+  PA.preserve<LoopAnalysis>();
+  return PA;
 }
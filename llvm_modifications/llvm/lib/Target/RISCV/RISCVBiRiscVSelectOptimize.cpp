@@ -0,0 +1,327 @@
+//===-- RISCVBiRiscVSelectOptimize.cpp - Turn predictable selects into br -===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// With XBiRiscV every select is legal and becomes a CMOV or CSEL. A CMOV has
+// to wait for both of its operands, so for
+//
+//   x = likely ? a : table[i] / d;
+//
+// the load and the divide are on the critical path even though their result
+// is almost never used. When the branch weights say the condition is
+// predictable, a branch that skips the unlikely operand is cheaper.
+//
+// For each select with branch weights above the target's predictable branch
+// threshold, the pass collects the single-use instructions in its block that
+// only feed one operand (the operand's dependency chain) and estimates the
+// latency of each chain from the scheduling model. If the unlikely operand
+// has a load, multiply or divide on its chain and the critical path saved
+// is longer than the branch and its expected misprediction cost, the select
+// is turned into a branch and the unlikely chain is sunk into its own block.
+//
+// Selects without branch weights are taken to be unpredictable and stay
+// CMOV/CSEL.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCV.h"
+#include "RISCVSubtarget.h"
+#include "RISCVTargetMachine.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/CodeGen/TargetPassConfig.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/ProfDataUtils.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/BranchProbability.h"
+#include "llvm/Support/CommandLine.h"
+
+using namespace llvm;
+
+// Statistics and remarks share the name of RISCVBiRiscVPatterns
+#define DEBUG_TYPE "riscv-biriscv-patterns"
+#define RISCV_BIRISCV_SELECT_OPT_NAME "RISC-V BiRiscV select optimization"
+
+STATISTIC(NumSelectsToBranches,
+          "Number of predictable selects turned into branches");
+
+static cl::opt<unsigned> SelectOptMaxSinkInstrs(
+    "riscv-biriscv-select-max-sink", cl::Hidden, cl::init(8),
+    cl::desc("Maximum number of instructions sunk into each side of a select "
+             "turned into a branch"));
+
+namespace {
+
+// The instructions computing one select operand that nothing else needs
+struct OperandChain {
+  SmallVector<Instruction *, 8> Instrs; // In program order
+  unsigned Latency = 0;
+  bool HasLongLatencyOp = false;
+};
+
+class RISCVBiRiscVSelectOptimize : public FunctionPass {
+public:
+  static char ID;
+
+  RISCVBiRiscVSelectOptimize() : FunctionPass(ID) {}
+
+  bool runOnFunction(Function &Fn) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<TargetPassConfig>();
+    AU.addRequired<OptimizationRemarkEmitterWrapperPass>();
+  }
+
+  StringRef getPassName() const override {
+    return RISCV_BIRISCV_SELECT_OPT_NAME;
+  }
+
+private:
+  const RISCVSubtarget *ST = nullptr;
+  OptimizationRemarkEmitter *ORE = nullptr;
+
+  unsigned getLatency(const Instruction &I) const;
+  void collectChain(SelectInst *SI, Value *V, OperandChain &Chain) const;
+  bool tryConvert(SelectInst *SI);
+};
+
+} // end anonymous namespace
+
+char RISCVBiRiscVSelectOptimize::ID = 0;
+
+INITIALIZE_PASS_BEGIN(RISCVBiRiscVSelectOptimize, "riscv-biriscv-select-opt",
+                      RISCV_BIRISCV_SELECT_OPT_NAME, false, false)
+INITIALIZE_PASS_DEPENDENCY(TargetPassConfig)
+INITIALIZE_PASS_DEPENDENCY(OptimizationRemarkEmitterWrapperPass)
+INITIALIZE_PASS_END(RISCVBiRiscVSelectOptimize, "riscv-biriscv-select-opt",
+                    RISCV_BIRISCV_SELECT_OPT_NAME, false, false)
+
+// The machine instruction an IR instruction is selected to, if it is one of
+// the long-latency ones
+static unsigned getLongLatencyOpcode(const Instruction &I) {
+  switch (I.getOpcode()) {
+  case Instruction::Load:
+    return RISCV::LW;
+  case Instruction::Mul:
+    return RISCV::MUL;
+  case Instruction::SDiv:
+    return RISCV::DIV;
+  case Instruction::UDiv:
+    return RISCV::DIVU;
+  case Instruction::SRem:
+    return RISCV::REM;
+  case Instruction::URem:
+    return RISCV::REMU;
+  }
+  return 0;
+}
+
+// Latency of I according to the scheduling model; everything that is not a
+// load, multiply or divide is taken as a single-cycle ALU operation
+unsigned RISCVBiRiscVSelectOptimize::getLatency(const Instruction &I) const {
+  unsigned Opcode = getLongLatencyOpcode(I);
+  if (!Opcode)
+    return 1;
+
+  const MCSchedModel &SM = ST->getSchedModel();
+  if (!SM.hasInstrSchedModel())
+    return Opcode == RISCV::LW ? SM.LoadLatency : SM.HighLatency;
+  const MCSchedClassDesc *SCDesc =
+      SM.getSchedClassDesc(ST->getInstrInfo()->get(Opcode).getSchedClass());
+  if (!SCDesc->isValid() || SCDesc->isVariant())
+    return Opcode == RISCV::LW ? SM.LoadLatency : SM.HighLatency;
+  return std::max(MCSchedModel::computeInstrLatency(*ST, *SCDesc), 1);
+}
+
+// Collect the instructions in the select's block that only compute V, and
+// the latency of the longest path through them.
+void RISCVBiRiscVSelectOptimize::collectChain(SelectInst *SI, Value *V,
+                                              OperandChain &Chain) const {
+  BasicBlock *BB = SI->getParent();
+  DenseMap<const Instruction *, unsigned> Depth;
+  SmallVector<Instruction *, 8> Worklist;
+
+  auto IsSinkable = [&](Value *Op) -> Instruction * {
+    auto *I = dyn_cast<Instruction>(Op);
+    if (!I || I->getParent() != BB || !I->hasOneUse() || isa<PHINode>(I) ||
+        I->mayHaveSideEffects() || I->isEHPad() || Depth.count(I))
+      return nullptr;
+    // A load may only move past the instructions before the select if none
+    // of them writes memory
+    if (I->mayReadFromMemory()) {
+      if (!isa<LoadInst>(I) || cast<LoadInst>(I)->isVolatile())
+        return nullptr;
+      for (auto It = std::next(I->getIterator()); &*It != SI; ++It)
+        if (It->mayWriteToMemory())
+          return nullptr;
+    }
+    return I;
+  };
+
+  if (Instruction *Root = IsSinkable(V)) {
+    Depth[Root] = 0;
+    Worklist.push_back(Root);
+  }
+  while (!Worklist.empty()) {
+    Instruction *I = Worklist.pop_back_val();
+    Chain.Instrs.push_back(I);
+    if (Chain.Instrs.size() > SelectOptMaxSinkInstrs) {
+      Chain = OperandChain();
+      return;
+    }
+    for (Value *Op : I->operands())
+      if (Instruction *OpI = IsSinkable(Op)) {
+        Depth[OpI] = 0;
+        Worklist.push_back(OpI);
+      }
+  }
+
+  // Longest path, visiting the chain in program order
+  sort(Chain.Instrs, [](Instruction *A, Instruction *B) {
+    return A->comesBefore(B);
+  });
+  for (Instruction *I : Chain.Instrs) {
+    unsigned Start = 0;
+    for (Value *Op : I->operands())
+      if (auto *OpI = dyn_cast<Instruction>(Op))
+        if (Depth.count(OpI))
+          Start = std::max(Start, Depth[OpI]);
+    Depth[I] = Start + getLatency(*I);
+    Chain.Latency = std::max(Chain.Latency, Depth[I]);
+    if (getLongLatencyOpcode(*I))
+      Chain.HasLongLatencyOp = true;
+  }
+}
+
+bool RISCVBiRiscVSelectOptimize::tryConvert(SelectInst *SI) {
+  if (!SI->getType()->isIntOrPtrTy() ||
+      !SI->getCondition()->getType()->isIntegerTy(1))
+    return false;
+
+  uint64_t TrueWeight, FalseWeight;
+  if (!extractBranchWeights(*SI, TrueWeight, FalseWeight) ||
+      TrueWeight + FalseWeight == 0)
+    return false;
+  BranchProbability TrueProb =
+      BranchProbability::getBranchProbability(TrueWeight,
+                                              TrueWeight + FalseWeight);
+  bool TrueLikely = TrueProb >= BranchProbability(1, 2);
+  BranchProbability LikelyProb = TrueLikely ? TrueProb : TrueProb.getCompl();
+  if (LikelyProb < ST->getTargetLowering()->getPredictableBranchThreshold())
+    return false;
+
+  OperandChain TrueChain, FalseChain;
+  collectChain(SI, SI->getTrueValue(), TrueChain);
+  collectChain(SI, SI->getFalseValue(), FalseChain);
+  const OperandChain &Likely = TrueLikely ? TrueChain : FalseChain;
+  const OperandChain &Unlikely = TrueLikely ? FalseChain : TrueChain;
+  if (!Unlikely.HasLongLatencyOp)
+    return false;
+
+  // The CMOV waits for both chains and then takes a cycle itself; the
+  // branch only waits for the likely chain, but costs a cycle and now and
+  // then a misprediction
+  const MCSchedModel &SM = ST->getSchedModel();
+  unsigned SelectCost = std::max(TrueChain.Latency, FalseChain.Latency) + 1;
+  unsigned BranchCost = Likely.Latency + 1 +
+                        LikelyProb.getCompl().scale(SM.MispredictPenalty);
+  if (BranchCost >= SelectCost) {
+    ORE->emit([&]() {
+      return OptimizationRemarkMissed(DEBUG_TYPE, "SelectKept", SI)
+             << "predictable select kept: branch cost "
+             << ore::NV("BranchCost", BranchCost) << " vs select cost "
+             << ore::NV("SelectCost", SelectCost);
+    });
+    return false;
+  }
+
+  ORE->emit([&]() {
+    return OptimizationRemark(DEBUG_TYPE, "SelectToBranch", SI)
+           << "predictable select turned into a branch: branch cost "
+           << ore::NV("BranchCost", BranchCost) << " vs select cost "
+           << ore::NV("SelectCost", SelectCost);
+  });
+
+  // start:                         start:
+  //   a = ...                        a = ...
+  //   b = load                       br c, select.end, select.false
+  //   x = select c, a, b   -->     select.false:
+  //                                  b = load
+  //                                  br select.end
+  //                                select.end:
+  //                                  x = phi [a, start], [b, select.false]
+  BasicBlock *StartBB = SI->getParent();
+  BasicBlock *EndBB = StartBB->splitBasicBlock(SI, "select.end");
+  LLVMContext &Ctx = SI->getContext();
+  Function *F = StartBB->getParent();
+
+  auto SinkChain = [&](const OperandChain &Chain,
+                       const Twine &Name) -> BasicBlock * {
+    if (Chain.Instrs.empty())
+      return nullptr;
+    BasicBlock *BB = BasicBlock::Create(Ctx, Name, F, EndBB);
+    BranchInst::Create(EndBB, BB);
+    for (Instruction *I : Chain.Instrs)
+      I->moveBefore(BB->getTerminator()->getIterator());
+    return BB;
+  };
+  BasicBlock *TrueBB = SinkChain(TrueChain, "select.true.sink");
+  BasicBlock *FalseBB = SinkChain(FalseChain, "select.false.sink");
+
+  // Branching on poison is undefined, selecting on it is not
+  IRBuilder<> Builder(StartBB->getTerminator());
+  Value *Cond = SI->getCondition();
+  if (!isGuaranteedNotToBeUndefOrPoison(Cond))
+    Cond = Builder.CreateFreeze(Cond, Cond->getName() + ".frozen");
+  BranchInst *Br = Builder.CreateCondBr(Cond, TrueBB ? TrueBB : EndBB,
+                                        FalseBB ? FalseBB : EndBB);
+  Br->setMetadata(LLVMContext::MD_prof,
+                  SI->getMetadata(LLVMContext::MD_prof));
+  StartBB->getTerminator()->eraseFromParent();
+
+  PHINode *PN = PHINode::Create(SI->getType(), 2, "", SI->getIterator());
+  PN->takeName(SI);
+  PN->addIncoming(SI->getTrueValue(), TrueBB ? TrueBB : StartBB);
+  PN->addIncoming(SI->getFalseValue(), FalseBB ? FalseBB : StartBB);
+  PN->setDebugLoc(SI->getDebugLoc());
+  SI->replaceAllUsesWith(PN);
+  SI->eraseFromParent();
+
+  ++NumSelectsToBranches;
+  return true;
+}
+
+bool RISCVBiRiscVSelectOptimize::runOnFunction(Function &Fn) {
+  if (skipFunction(Fn) || Fn.hasOptSize())
+    return false;
+
+  auto &TM = getAnalysis<TargetPassConfig>().getTM<RISCVTargetMachine>();
+  ST = &TM.getSubtarget<RISCVSubtarget>(Fn);
+  if (!ST->hasBiRiscVCondMov())
+    return false;
+  ORE = &getAnalysis<OptimizationRemarkEmitterWrapperPass>().getORE();
+
+  // Collect the selects first, since converting one splits its block
+  SmallVector<SelectInst *, 16> Selects;
+  for (BasicBlock &BB : Fn)
+    for (Instruction &I : BB)
+      if (auto *SI = dyn_cast<SelectInst>(&I))
+        Selects.push_back(SI);
+
+  bool MadeChange = false;
+  for (SelectInst *SI : Selects)
+    if (tryConvert(SI))
+      MadeChange = true;
+  return MadeChange;
+}
+
+FunctionPass *llvm::createRISCVBiRiscVSelectOptimizePass() {
+  return new RISCVBiRiscVSelectOptimize();
+}
@@ -0,0 +1,271 @@
+//===-- RISCVBiRiscVSinkOperands.cpp - Sink XBiRiscV feeders to users -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The MADD, CSEL/CMOV and SAD patterns in RISCVInstrInfoBiRiscV.td are
+// SelectionDAG patterns, so they only match when the feeding instruction is
+// in the same basic block as its user:
+//
+//   mul          + add              -> MADD
+//   icmp         + select           -> CSEL/CMOV on the compared value
+//   sad(a, b, 0) + add              -> SAD with the add operand as rs3
+//                                      (likewise SADS, SAD16, SATD4,
+//                                      DMADD16/DMADD16U and the DOT4s)
+//
+// LICM, GVN and loop rotation often leave the feeder in another block, and
+// instruction selection then emits a separate MUL, a materialized compare or
+// a separate ADD. This pass runs right before instruction selection and
+// moves (or, if the users are in several blocks, duplicates) such feeders
+// next to their users.
+//
+// A feeder is never moved into a loop that does not contain it, since it
+// would then execute on every iteration instead of once. A MUL or SAD is only
+// moved if none of its users stay behind, and only duplicated into user
+// blocks none of which can reach another, so each path runs at most one
+// copy and the number of multiplies and SADs executed on any path does not
+// grow.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RISCV.h"
+#include "RISCVSubtarget.h"
+#include "RISCVTargetMachine.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/CFG.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/CodeGen/TargetPassConfig.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/IntrinsicsRISCV.h"
+#include "llvm/IR/PatternMatch.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+
+using namespace llvm;
+using namespace PatternMatch;
+
+// Statistics and remarks share the name of RISCVBiRiscVPatterns
+#define DEBUG_TYPE "riscv-biriscv-patterns"
+#define RISCV_BIRISCV_SINK_OPERANDS_NAME "RISC-V BiRiscV operand sinking"
+
+STATISTIC(NumMulsSunk, "Number of MULs sunk next to their add for MADD");
+STATISTIC(NumCmpsSunk, "Number of compares sunk next to their select");
+STATISTIC(NumSADsSunk, "Number of SADs sunk next to their add");
+STATISTIC(NumFeedersCloned, "Number of extra copies made of sunk feeders");
+
+static cl::opt<unsigned> SinkMaxCopies(
+    "riscv-biriscv-sink-max-copies", cl::Hidden, cl::init(2),
+    cl::desc("Maximum number of blocks a MUL, compare or SAD is sunk into"));
+
+namespace {
+
+enum class FeederKind { None, Mul, Cmp, SAD };
+
+class RISCVBiRiscVSinkOperands : public FunctionPass {
+public:
+  static char ID;
+
+  RISCVBiRiscVSinkOperands() : FunctionPass(ID) {}
+
+  bool runOnFunction(Function &Fn) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.setPreservesCFG();
+    AU.addRequired<TargetPassConfig>();
+    AU.addRequired<LoopInfoWrapperPass>();
+    AU.addRequired<OptimizationRemarkEmitterWrapperPass>();
+    AU.addPreserved<LoopInfoWrapperPass>();
+  }
+
+  StringRef getPassName() const override {
+    return RISCV_BIRISCV_SINK_OPERANDS_NAME;
+  }
+
+private:
+  LoopInfo *LI = nullptr;
+  OptimizationRemarkEmitter *ORE = nullptr;
+
+  bool trySink(Instruction &I);
+};
+
+} // end anonymous namespace
+
+char RISCVBiRiscVSinkOperands::ID = 0;
+
+INITIALIZE_PASS_BEGIN(RISCVBiRiscVSinkOperands, "riscv-biriscv-sink-operands",
+                      RISCV_BIRISCV_SINK_OPERANDS_NAME, false, false)
+INITIALIZE_PASS_DEPENDENCY(TargetPassConfig)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(OptimizationRemarkEmitterWrapperPass)
+INITIALIZE_PASS_END(RISCVBiRiscVSinkOperands, "riscv-biriscv-sink-operands",
+                    RISCV_BIRISCV_SINK_OPERANDS_NAME, false, false)
+
+static FeederKind getFeederKind(const Instruction &I) {
+  if (!I.getType()->isIntegerTy())
+    return FeederKind::None;
+  if (I.getOpcode() == Instruction::Mul && I.getType()->isIntegerTy(32))
+    return FeederKind::Mul;
+  if (isa<ICmpInst>(I) && I.getOperand(0)->getType()->isIntOrPtrTy())
+    return FeederKind::Cmp;
+  if (match(&I, m_Intrinsic<Intrinsic::riscv_biriscv_sad>(
+                    m_Value(), m_Value(), m_Zero())) ||
+      match(&I, m_Intrinsic<Intrinsic::riscv_biriscv_sads>(
+                    m_Value(), m_Value(), m_Zero())) ||
+      match(&I, m_Intrinsic<Intrinsic::riscv_biriscv_sad16>(
+                    m_Value(), m_Value(), m_Zero())) ||
+      match(&I, m_Intrinsic<Intrinsic::riscv_biriscv_satd4>(
+                    m_Value(), m_Value(), m_Zero())) ||
+      match(&I, m_Intrinsic<Intrinsic::riscv_biriscv_dmadd16>(
+                    m_Value(), m_Value(), m_Zero())) ||
+      match(&I, m_Intrinsic<Intrinsic::riscv_biriscv_dmadd16u>(
+                    m_Value(), m_Value(), m_Zero())) ||
+      match(&I, m_Intrinsic<Intrinsic::riscv_biriscv_dot4>(
+                    m_Value(), m_Value(), m_Zero())) ||
+      match(&I, m_Intrinsic<Intrinsic::riscv_biriscv_dot4u>(
+                    m_Value(), m_Value(), m_Zero())) ||
+      match(&I, m_Intrinsic<Intrinsic::riscv_biriscv_dot4us>(
+                    m_Value(), m_Value(), m_Zero())))
+    return FeederKind::SAD;
+  return FeederKind::None;
+}
+
+// Would U fuse with its feeder if both were in the same block?
+static bool isFusingUse(const Use &U, FeederKind Kind) {
+  auto *User = cast<Instruction>(U.getUser());
+  switch (Kind) {
+  case FeederKind::Mul:
+  case FeederKind::SAD:
+    return User->getOpcode() == Instruction::Add &&
+           User->getType()->isIntegerTy(32);
+  case FeederKind::Cmp:
+    return isa<SelectInst>(User) && U.getOperandNo() == 0 &&
+           User->getType()->isIntegerTy();
+  case FeederKind::None:
+    break;
+  }
+  return false;
+}
+
+bool RISCVBiRiscVSinkOperands::trySink(Instruction &I) {
+  FeederKind Kind = getFeederKind(I);
+  if (Kind == FeederKind::None)
+    return false;
+
+  BasicBlock *DefBB = I.getParent();
+
+  // Uses in blocks other than the defining one, per block
+  MapVector<BasicBlock *, SmallVector<Use *, 2>> UsesByBlock;
+  bool UsedInDefBB = false;
+  for (Use &U : I.uses()) {
+    auto *User = cast<Instruction>(U.getUser());
+    BasicBlock *UseBB = User->getParent();
+    if (UseBB == DefBB) {
+      UsedInDefBB = true;
+      continue;
+    }
+    if (!isFusingUse(U, Kind))
+      return false;
+    // Do not move the feeder into a loop it is not already in
+    Loop *UseLoop = LI->getLoopFor(UseBB);
+    if (UseLoop && !UseLoop->contains(DefBB))
+      return false;
+    UsesByBlock[UseBB].push_back(&U);
+  }
+
+  if (UsesByBlock.empty() || UsesByBlock.size() > SinkMaxCopies)
+    return false;
+  // A MUL or SAD that still executes in its own block would only add work,
+  // and so would two copies on one path (DefBB -> BB1 -> BB2 with an add in
+  // both turns one MUL into two MADDs on the shared multiplier)
+  if (Kind != FeederKind::Cmp) {
+    if (UsedInDefBB)
+      return false;
+    for (auto &[From, FromUses] : UsesByBlock)
+      for (auto &[To, ToUses] : UsesByBlock)
+        if (From != To &&
+            isPotentiallyReachable(From, To, nullptr, nullptr, LI))
+          return false;
+  }
+
+  for (auto &[UseBB, Uses] : UsesByBlock) {
+    // Place the copy in front of the first user in the block
+    Instruction *InsertPt = nullptr;
+    for (Use *U : Uses) {
+      auto *User = cast<Instruction>(U->getUser());
+      if (!InsertPt || User->comesBefore(InsertPt))
+        InsertPt = User;
+    }
+
+    Instruction *Copy;
+    if (!UsedInDefBB && UseBB == UsesByBlock.back().first) {
+      // The last block takes the original
+      Copy = &I;
+      Copy->moveBefore(InsertPt->getIterator());
+    } else {
+      Copy = I.clone();
+      Copy->setName(I.getName() + ".sunk");
+      Copy->insertBefore(InsertPt->getIterator());
+      ++NumFeedersCloned;
+    }
+    for (Use *U : Uses)
+      U->set(Copy);
+  }
+
+  switch (Kind) {
+  case FeederKind::Mul:
+    ++NumMulsSunk;
+    break;
+  case FeederKind::Cmp:
+    ++NumCmpsSunk;
+    break;
+  case FeederKind::SAD:
+    ++NumSADsSunk;
+    break;
+  case FeederKind::None:
+    break;
+  }
+
+  ORE->emit([&]() {
+    return OptimizationRemark(DEBUG_TYPE, "OperandSunk", &I)
+           << "sunk " << ore::NV("Instruction", I.getOpcodeName())
+           << " into " << ore::NV("NumBlocks", UsesByBlock.size())
+           << " user block(s)";
+  });
+  return true;
+}
+
+bool RISCVBiRiscVSinkOperands::runOnFunction(Function &Fn) {
+  if (skipFunction(Fn))
+    return false;
+
+  auto &TM = getAnalysis<TargetPassConfig>().getTM<RISCVTargetMachine>();
+  if (!TM.getSubtarget<RISCVSubtarget>(Fn).hasStdExtXBiRiscV())
+    return false;
+
+  LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+  ORE = &getAnalysis<OptimizationRemarkEmitterWrapperPass>().getORE();
+
+  // Collect the candidates first, since sinking moves them between blocks
+  SmallVector<Instruction *, 32> Feeders;
+  for (BasicBlock &BB : Fn)
+    for (Instruction &I : BB)
+      if (getFeederKind(I) != FeederKind::None)
+        Feeders.push_back(&I);
+
+  bool MadeChange = false;
+  for (Instruction *I : Feeders)
+    if (trySink(*I))
+      MadeChange = true;
+  return MadeChange;
+}
+
+FunctionPass *llvm::createRISCVBiRiscVSinkOperandsPass() {
+  return new RISCVBiRiscVSinkOperands();
+}
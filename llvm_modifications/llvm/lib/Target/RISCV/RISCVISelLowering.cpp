@@ -444,6 +444,10 @@ RISCVTargetLowering::RISCVTargetLowering(const TargetMachine &TM,
   // BiRiscV custom instructions
   if (Subtarget.hasStdExtXBiRiscV()) {
     setOperationAction(ISD::BITREVERSE, XLenVT, Legal);
+    // MIN/MAX/MINU/MAXU. ABS then expands to max(x, 0 - x).
+    if (!Subtarget.is64Bit())
+      setOperationAction({ISD::SMIN, ISD::SMAX, ISD::UMIN, ISD::UMAX}, XLenVT,
+                         Legal);
   }
 
   if (Subtarget.hasVendorXqcia() && !Subtarget.is64Bit()) {
@@ -1627,6 +1631,14 @@ RISCVTargetLowering::RISCVTargetLowering(const TargetMachine &TM,
   // Set preferred alignments.
   setPrefFunctionAlignment(Subtarget.getPrefFunctionAlignment());
   setPrefLoopAlignment(Subtarget.getPrefLoopAlignment());
+  // biriscv only pairs instructions from the same 8-byte fetch group. Start
+  // functions and loops on a group so the post-RA scheduler knows which
+  // ones can pair.
+  if (Subtarget.getProcFamily() == RISCVSubtarget::BiRiscV &&
+      !Subtarget.hasStdExtZca()) {
+    setPrefFunctionAlignment(Align(8));
+    setPrefLoopAlignment(Align(8));
+  }
 
   setTargetDAGCombine({ISD::INTRINSIC_VOID, ISD::INTRINSIC_W_CHAIN,
                        ISD::INTRINSIC_WO_CHAIN, ISD::ADD, ISD::SUB, ISD::MUL,
@@ -15779,6 +15791,156 @@ static SDValue reduceANDOfAtomicLoad(SDNode *N,
   return SDValue(N, 0);
 }
 
+// Truth tables of the TERNLOG/TERNLOG3 sources. The LUT index is
+// {rs1, rs2, rs3}. TERNLOG has no third source and indexes with 0 instead, so
+// it only reads the even entries of imm8.
+static constexpr unsigned TernlogSrcMasks[] = {0xF0, 0xCC, 0xAA};
+static constexpr unsigned TernlogSrcShifts[] = {4, 2, 1};
+
+// Returns true if the function in Table depends on source I.
+static bool ternlogTableDependsOn(unsigned Table, unsigned I) {
+  unsigned Mask = TernlogSrcMasks[I];
+  return ((Table & Mask) >> TernlogSrcShifts[I]) != (Table & ~Mask & 0xFF);
+}
+
+// Walk a tree of and/or/xor/not rooted at Op and compute its truth table over
+// at most three sources. Cost is the number of base ISA instructions the tree
+// needs. Nodes with other users stay in the DAG anyway, so they are treated as
+// sources.
+static std::optional<unsigned>
+computeTernlogTable(SDValue Op, bool IsRoot, SmallVectorImpl<SDValue> &Srcs,
+                    unsigned &Cost, bool HasNotFolding, unsigned Depth = 0) {
+  if (Depth > 4)
+    return std::nullopt;
+
+  if (auto *C = dyn_cast<ConstantSDNode>(Op)) {
+    if (C->isZero())
+      return 0x00;
+    if (C->isAllOnes())
+      return 0xFF;
+    // Other constants need an LI first; ANDI/ORI/XORI do better.
+    return std::nullopt;
+  }
+
+  unsigned Opc = Op.getOpcode();
+  bool IsBitwise = Opc == ISD::AND || Opc == ISD::OR || Opc == ISD::XOR;
+  if (!IsBitwise || (!IsRoot && !Op.hasOneUse())) {
+    for (unsigned I = 0, E = Srcs.size(); I != E; ++I)
+      if (Srcs[I] == Op)
+        return TernlogSrcMasks[I];
+    if (Srcs.size() == 3)
+      return std::nullopt;
+    Srcs.push_back(Op);
+    return TernlogSrcMasks[Srcs.size() - 1];
+  }
+
+  if (Opc == ISD::XOR && isAllOnesConstant(Op.getOperand(1))) {
+    SDValue Src = Op.getOperand(0);
+    std::optional<unsigned> T = computeTernlogTable(
+        Src, /*IsRoot=*/false, Srcs, Cost, HasNotFolding, Depth + 1);
+    if (!T)
+      return std::nullopt;
+    ++Cost;
+    return ~*T & 0xFF;
+  }
+
+  unsigned Tables[2];
+  for (unsigned I = 0; I != 2; ++I) {
+    SDValue Operand = Op.getOperand(I);
+    std::optional<unsigned> T = computeTernlogTable(
+        Operand, /*IsRoot=*/false, Srcs, Cost, HasNotFolding, Depth + 1);
+    if (!T)
+      return std::nullopt;
+    // Zbb/Zbkb fold a NOT operand into ANDN/ORN/XNOR.
+    if (HasNotFolding && Operand.getOpcode() == ISD::XOR &&
+        Operand.hasOneUse() && isAllOnesConstant(Operand.getOperand(1)))
+      --Cost;
+    Tables[I] = *T;
+  }
+  ++Cost;
+
+  switch (Opc) {
+  case ISD::AND:
+    return Tables[0] & Tables[1];
+  case ISD::OR:
+    return Tables[0] | Tables[1];
+  default:
+    return Tables[0] ^ Tables[1];
+  }
+}
+
+// Replace a tree of and/or/xor/not over up to three values with a single
+// XBiRiscV TERNLOG or TERNLOG3, e.g. (or (and a, m), (and b, (not m))) or
+// (xor a, (xor b, c)).
+static SDValue combineBitwiseToTernlog(SDNode *N,
+                                       TargetLowering::DAGCombinerInfo &DCI,
+                                       const RISCVSubtarget &Subtarget) {
+  if (!Subtarget.hasStdExtXBiRiscV() || Subtarget.is64Bit() ||
+      !DCI.isAfterLegalizeDAG() || N->getValueType(0) != MVT::i32)
+    return SDValue();
+
+  SmallVector<SDValue, 3> Srcs;
+  unsigned Cost = 0;
+  bool HasNotFolding = Subtarget.hasStdExtZbb() || Subtarget.hasStdExtZbkb();
+  std::optional<unsigned> Table = computeTernlogTable(
+      SDValue(N, 0), /*IsRoot=*/true, Srcs, Cost, HasNotFolding);
+  if (!Table || Srcs.size() < 2)
+    return SDValue();
+
+  SelectionDAG &DAG = DCI.DAG;
+  SDLoc DL(N);
+  MVT XLenVT = Subtarget.getXLenVT();
+
+  SmallVector<SDValue, 3> Used;
+  for (unsigned I = 0, E = Srcs.size(); I != E; ++I)
+    if (ternlogTableDependsOn(*Table, I))
+      Used.push_back(Srcs[I]);
+
+  // The tree may have folded away to a constant or one of its sources.
+  if (Used.empty())
+    return *Table ? DAG.getAllOnesConstant(DL, XLenVT)
+                  : DAG.getConstant(0, DL, XLenVT);
+  if (Used.size() == 1) {
+    for (unsigned I = 0, E = Srcs.size(); I != E; ++I)
+      if (Srcs[I] == Used[0] && *Table == TernlogSrcMasks[I])
+        return Used[0];
+    return SDValue();
+  }
+
+  // TERNLOG3 overwrites its third source, so that source needs a copy if it
+  // has users outside the tree. Pick one that does not if possible.
+  bool NeedsCopy = false;
+  if (Used.size() == 3) {
+    auto *It = find_if(Used, [](SDValue V) { return V.hasOneUse(); });
+    if (It == Used.end())
+      NeedsCopy = true;
+    else
+      std::rotate(It, std::next(It), Used.end());
+  }
+
+  // Recompute the table for the final source order. Sources the expression
+  // does not depend on end up last and do not change it.
+  Srcs.assign(Used.begin(), Used.end());
+  Cost = 0;
+  Table = computeTernlogTable(SDValue(N, 0), /*IsRoot=*/true, Srcs, Cost,
+                              HasNotFolding);
+  assert(Table && "Recomputing the TERNLOG table failed");
+
+  if (Cost < (NeedsCopy ? 3u : 2u))
+    return SDValue();
+
+  SDValue Imm = DAG.getTargetConstant(*Table, DL, XLenVT);
+  if (Used.size() == 2)
+    return DAG.getNode(
+        ISD::INTRINSIC_WO_CHAIN, DL, XLenVT,
+        DAG.getTargetConstant(Intrinsic::riscv_biriscv_ternlog, DL, XLenVT),
+        Used[0], Used[1], Imm);
+  return DAG.getNode(
+      ISD::INTRINSIC_WO_CHAIN, DL, XLenVT,
+      DAG.getTargetConstant(Intrinsic::riscv_biriscv_ternlog3, DL, XLenVT),
+      Used[0], Used[1], Used[2], Imm);
+}
+
 // Combines two comparison operation and logic operation to one selection
 // operation(min, max) and logic operation. Returns new constructed Node if
 // conditions for optimization are satisfied.
@@ -19839,13 +20001,19 @@ SDValue RISCVTargetLowering::PerformDAGCombine(SDNode *N,
     return performSUBCombine(N, DAG, Subtarget);
   }
   case ISD::AND:
+    if (SDValue V = combineBitwiseToTernlog(N, DCI, Subtarget))
+      return V;
     return performANDCombine(N, DCI, Subtarget);
   case ISD::OR: {
     if (SDValue V = combineOp_VLToVWOp_VL(N, DCI, Subtarget))
       return V;
+    if (SDValue V = combineBitwiseToTernlog(N, DCI, Subtarget))
+      return V;
     return performORCombine(N, DCI, Subtarget);
   }
   case ISD::XOR:
+    if (SDValue V = combineBitwiseToTernlog(N, DCI, Subtarget))
+      return V;
     return performXORCombine(N, DAG, Subtarget);
   case ISD::MUL:
     if (SDValue V = combineOp_VLToVWOp_VL(N, DCI, Subtarget))
@@ -85,6 +85,7 @@ public:
     VentanaVeyron,
     MIPSP8700,
     Andes45,
+    BiRiscV,
   };
   enum RISCVVRGatherCostModelEnum : uint8_t {
     Quadratic,
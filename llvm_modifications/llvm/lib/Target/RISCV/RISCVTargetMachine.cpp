@@ -13,6 +13,7 @@
 #include "RISCVTargetMachine.h"
 #include "MCTargetDesc/RISCVBaseInfo.h"
 #include "RISCV.h"
+#include "RISCVBiRiscVHazardRecognizer.h"
 #include "RISCVMachineFunctionInfo.h"
 #include "RISCVTargetObjectFile.h"
 #include "RISCVTargetTransformInfo.h"
@@ -119,6 +120,11 @@ static cl::opt<bool>
                            cl::desc("Enable Machine Pipeliner for RISC-V"),
                            cl::init(false), cl::Hidden);
 
+static cl::opt<bool> EnableBiRiscVEarlyIfConv(
+    "riscv-biriscv-early-ifcvt", cl::Hidden,
+    cl::desc("Enable if-conversion into CSEL/CMOV for XBiRiscV"),
+    cl::init(true));
+
 extern "C" LLVM_ABI LLVM_EXTERNAL_VISIBILITY void LLVMInitializeRISCVTarget() {
   RegisterTargetMachine<RISCVTargetMachine> X(getTheRISCV32Target());
   RegisterTargetMachine<RISCVTargetMachine> Y(getTheRISCV64Target());
@@ -133,6 +139,10 @@ extern "C" LLVM_ABI LLVM_EXTERNAL_VISIBILITY void LLVMInitializeRISCVTarget() {
   initializeRISCVMakeCompressibleOptPass(*PR);
   initializeRISCVGatherScatterLoweringPass(*PR);
   initializeRISCVBiRiscVPatternsPass(*PR);
+  initializeRISCVBiRiscVEarlyIfConvertPass(*PR);
+  initializeRISCVBiRiscVInstrStatsPass(*PR);
+  initializeRISCVBiRiscVSelectOptimizePass(*PR);
+  initializeRISCVBiRiscVSinkOperandsPass(*PR);
   initializeRISCVCodeGenPreparePass(*PR);
   initializeRISCVPostRAExpandPseudoPass(*PR);
   initializeRISCVMergeBaseOffsetOptPass(*PR);
@@ -317,7 +327,14 @@ RISCVTargetMachine::createMachineScheduler(MachineSchedContext *C) const {
 
 ScheduleDAGInstrs *
 RISCVTargetMachine::createPostMachineScheduler(MachineSchedContext *C) const {
-  ScheduleDAGMI *DAG = createSchedPostRA(C);
+  const RISCVSubtarget &ST = C->MF->getSubtarget<RISCVSubtarget>();
+  ScheduleDAGMI *DAG;
+  if (ST.getProcFamily() == RISCVSubtarget::BiRiscV)
+    DAG = new ScheduleDAGMI(
+        C, std::make_unique<RISCVBiRiscVPostRASchedStrategy>(C),
+        /*RemoveKillFlags=*/true);
+  else
+    DAG = createSchedPostRA(C);
   if (EnablePostMISchedLoadStoreClustering) {
     DAG->addMutation(createLoadClusterDAGMutation(
         DAG->TII, DAG->TRI, /*ReorderWhileClustering=*/true));
@@ -415,6 +432,7 @@ public:
   void addPreEmitPass2() override;
   void addPreSched2() override;
   void addMachineSSAOptimization() override;
+  bool addILPOpts() override;
   FunctionPass *createRVVRegAllocPass(bool Optimized);
   bool addRegAssignAndRewriteFast() override;
   bool addRegAssignAndRewriteOptimized() override;
@@ -479,6 +497,7 @@ void RISCVPassConfig::addIRPasses() {
     addPass(createRISCVGatherScatterLoweringPass());
     addPass(createInterleavedAccessPass());
     addPass(createRISCVBiRiscVPatternsPass());
+    addPass(createRISCVBiRiscVSelectOptimizePass());
     addPass(createRISCVCodeGenPreparePass());
   }
 
@@ -512,6 +531,10 @@ void RISCVPassConfig::addCodeGenPrepare() {
   if (getOptLevel() != CodeGenOptLevel::None)
     addPass(createTypePromotionLegacyPass());
   TargetPassConfig::addCodeGenPrepare();
+  // After CodeGenPrepare, so that nothing moves the feeders apart again
+  // before instruction selection
+  if (getOptLevel() != CodeGenOptLevel::None)
+    addPass(createRISCVBiRiscVSinkOperandsPass());
 }
 
 bool RISCVPassConfig::addInstSelector() {
@@ -615,6 +638,12 @@ void RISCVPassConfig::addMachineSSAOptimization() {
   }
 }
 
+bool RISCVPassConfig::addILPOpts() {
+  if (EnableBiRiscVEarlyIfConv)
+    addPass(createRISCVBiRiscVEarlyIfConvertPass());
+  return true;
+}
+
 void RISCVPassConfig::addPreRegAlloc() {
   addPass(createRISCVPreRAExpandPseudoPass());
   if (TM->getOptLevel() != CodeGenOptLevel::None) {
@@ -631,6 +660,9 @@ void RISCVPassConfig::addPreRegAlloc() {
     addPass(&MachinePipelinerID);
 
   addPass(createRISCVVMV0EliminationPass());
+
+  // Still in SSA form, so unfused MUL/ADD pairs can be traced to their uses
+  addPass(createRISCVBiRiscVInstrStatsPass());
 }
 
 void RISCVPassConfig::addFastRegAlloc() {
@@ -656,6 +688,24 @@ void RISCVTargetMachine::registerPassBuilderCallbacks(PassBuilder &PB) {
         if (Level.isOptimizingForSpeed())
           FPM.addPass(createFunctionToLoopPassAdaptor(EVLIndVarSimplifyPass()));
       });
+
+  // Form SAD loops and reductions after the scalar simplification pipeline
+  // (and its InstCombine runs) but before the vectorizer and the runtime
+  // unroller, so that unrolling sees the four-bytes-per-iteration SAD loop.
+  PB.registerVectorizerStartEPCallback(
+      [this](FunctionPassManager &FPM, OptimizationLevel Level) {
+        FPM.addPass(RISCVBiRiscVPatternsPass(*this));
+      });
+
+  PB.registerPipelineParsingCallback(
+      [this](StringRef Name, FunctionPassManager &FPM,
+             ArrayRef<PassBuilder::PipelineElement>) {
+        if (Name == "riscv-biriscv-patterns") {
+          FPM.addPass(RISCVBiRiscVPatternsPass(*this));
+          return true;
+        }
+        return false;
+      });
 }
 
 yaml::MachineFunctionInfo *
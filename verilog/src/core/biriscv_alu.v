@@ -25,7 +25,7 @@
 module biriscv_alu
 (
     // Inputs
-     input  [  4:0]  alu_op_i
+     input  [  5:0]  alu_op_i
     ,input  [ 31:0]  alu_a_i
     ,input  [ 31:0]  alu_b_i
     ,input  [ 31:0]  alu_c_i
@@ -58,13 +58,41 @@ reg [31:0]      shift_left_8_r;
 
 // SAD temporary registers for absolute differences
 reg [8:0] sad_abs0_r, sad_abs1_r, sad_abs2_r, sad_abs3_r;
+reg [16:0] sad16_abs0_r, sad16_abs1_r;
+
+// SATD4 butterfly sums/differences of the four signed halfwords and their magnitudes
+reg [16:0] satd_s01_r, satd_d01_r, satd_s23_r, satd_d23_r;
+reg [16:0] satd_abs_s01_r, satd_abs_d01_r, satd_abs_s23_r, satd_abs_d23_r;
+reg [16:0] satd_max_s_r, satd_max_d_r;
+
+// AVGU8 rounded lane sums
+reg [8:0] byte_avg0_r, byte_avg1_r, byte_avg2_r, byte_avg3_r;
 
 wire [31:0]     sub_res_w = alu_a_i - alu_b_i;
 
+// Shared by MIN/MAX/MINU/MAXU
+wire            less_than_w        = (alu_a_i < alu_b_i);
+wire            less_than_signed_w = (alu_a_i[31] != alu_b_i[31]) ? alu_a_i[31] : sub_res_w[31];
+
+// CLIP/CLIPU range: alu_b_i[4:0] = n, upper bound 2^n - 1, signed lower bound -2^n
+wire [31:0]     clip_max_w = (32'd1 << alu_b_i[4:0]) - 32'd1;
+wire [31:0]     clip_min_w = ~clip_max_w;
+
+// Packed byte lanes: 9-bit sum (bit 8 = carry out) and difference (bit 8 = borrow, a < b)
+wire [8:0]      byte_sum0_w  = {1'b0, alu_a_i[7:0]}   + {1'b0, alu_b_i[7:0]};
+wire [8:0]      byte_sum1_w  = {1'b0, alu_a_i[15:8]}  + {1'b0, alu_b_i[15:8]};
+wire [8:0]      byte_sum2_w  = {1'b0, alu_a_i[23:16]} + {1'b0, alu_b_i[23:16]};
+wire [8:0]      byte_sum3_w  = {1'b0, alu_a_i[31:24]} + {1'b0, alu_b_i[31:24]};
+wire [8:0]      byte_diff0_w = {1'b0, alu_a_i[7:0]}   - {1'b0, alu_b_i[7:0]};
+wire [8:0]      byte_diff1_w = {1'b0, alu_a_i[15:8]}  - {1'b0, alu_b_i[15:8]};
+wire [8:0]      byte_diff2_w = {1'b0, alu_a_i[23:16]} - {1'b0, alu_b_i[23:16]};
+wire [8:0]      byte_diff3_w = {1'b0, alu_a_i[31:24]} - {1'b0, alu_b_i[31:24]};
+
 //-----------------------------------------------------------------
 // ALU
 //-----------------------------------------------------------------
-always @ (alu_op_i or alu_a_i or alu_b_i or alu_c_i or alu_imm8_i or sub_res_w)
+always @ (alu_op_i or alu_a_i or alu_b_i or alu_c_i or alu_imm8_i or sub_res_w or less_than_w or less_than_signed_w or clip_max_w or clip_min_w or
+          byte_sum0_w or byte_sum1_w or byte_sum2_w or byte_sum3_w or byte_diff0_w or byte_diff1_w or byte_diff2_w or byte_diff3_w)
 begin
     shift_right_fill_r = 16'b0;
     shift_right_1_r = 32'b0;
@@ -207,44 +235,44 @@ begin
                         alu_a_i[28], alu_a_i[29], alu_a_i[30], alu_a_i[31]};
        end
        //----------------------------------------------
-       // Bitwise Ternary Logic (2-source + 8-bit immediate)
+       // Bitwise Ternary Logic (3-source + 8-bit immediate)
        //----------------------------------------------
        `ALU_TERNLOG :
        begin
-            // For each bit position, use rs1[i], rs2[i], 0 as 3-bit index into imm8 LUT
-            // Third input is constant 0, so index = {rs1[i], rs2[i], 0}
-            result_r = {alu_imm8_i[{alu_a_i[31], alu_b_i[31], 1'b0}],
-                        alu_imm8_i[{alu_a_i[30], alu_b_i[30], 1'b0}],
-                        alu_imm8_i[{alu_a_i[29], alu_b_i[29], 1'b0}],
-                        alu_imm8_i[{alu_a_i[28], alu_b_i[28], 1'b0}],
-                        alu_imm8_i[{alu_a_i[27], alu_b_i[27], 1'b0}],
-                        alu_imm8_i[{alu_a_i[26], alu_b_i[26], 1'b0}],
-                        alu_imm8_i[{alu_a_i[25], alu_b_i[25], 1'b0}],
-                        alu_imm8_i[{alu_a_i[24], alu_b_i[24], 1'b0}],
-                        alu_imm8_i[{alu_a_i[23], alu_b_i[23], 1'b0}],
-                        alu_imm8_i[{alu_a_i[22], alu_b_i[22], 1'b0}],
-                        alu_imm8_i[{alu_a_i[21], alu_b_i[21], 1'b0}],
-                        alu_imm8_i[{alu_a_i[20], alu_b_i[20], 1'b0}],
-                        alu_imm8_i[{alu_a_i[19], alu_b_i[19], 1'b0}],
-                        alu_imm8_i[{alu_a_i[18], alu_b_i[18], 1'b0}],
-                        alu_imm8_i[{alu_a_i[17], alu_b_i[17], 1'b0}],
-                        alu_imm8_i[{alu_a_i[16], alu_b_i[16], 1'b0}],
-                        alu_imm8_i[{alu_a_i[15], alu_b_i[15], 1'b0}],
-                        alu_imm8_i[{alu_a_i[14], alu_b_i[14], 1'b0}],
-                        alu_imm8_i[{alu_a_i[13], alu_b_i[13], 1'b0}],
-                        alu_imm8_i[{alu_a_i[12], alu_b_i[12], 1'b0}],
-                        alu_imm8_i[{alu_a_i[11], alu_b_i[11], 1'b0}],
-                        alu_imm8_i[{alu_a_i[10], alu_b_i[10], 1'b0}],
-                        alu_imm8_i[{alu_a_i[9],  alu_b_i[9],  1'b0}],
-                        alu_imm8_i[{alu_a_i[8],  alu_b_i[8],  1'b0}],
-                        alu_imm8_i[{alu_a_i[7],  alu_b_i[7],  1'b0}],
-                        alu_imm8_i[{alu_a_i[6],  alu_b_i[6],  1'b0}],
-                        alu_imm8_i[{alu_a_i[5],  alu_b_i[5],  1'b0}],
-                        alu_imm8_i[{alu_a_i[4],  alu_b_i[4],  1'b0}],
-                        alu_imm8_i[{alu_a_i[3],  alu_b_i[3],  1'b0}],
-                        alu_imm8_i[{alu_a_i[2],  alu_b_i[2],  1'b0}],
-                        alu_imm8_i[{alu_a_i[1],  alu_b_i[1],  1'b0}],
-                        alu_imm8_i[{alu_a_i[0],  alu_b_i[0],  1'b0}]};
+            // For each bit position, use rs1[i], rs2[i], c[i] as 3-bit index into imm8 LUT
+            // c is 0 for TERNLOG and the old rd value for TERNLOG3
+            result_r = {alu_imm8_i[{alu_a_i[31], alu_b_i[31], alu_c_i[31]}],
+                        alu_imm8_i[{alu_a_i[30], alu_b_i[30], alu_c_i[30]}],
+                        alu_imm8_i[{alu_a_i[29], alu_b_i[29], alu_c_i[29]}],
+                        alu_imm8_i[{alu_a_i[28], alu_b_i[28], alu_c_i[28]}],
+                        alu_imm8_i[{alu_a_i[27], alu_b_i[27], alu_c_i[27]}],
+                        alu_imm8_i[{alu_a_i[26], alu_b_i[26], alu_c_i[26]}],
+                        alu_imm8_i[{alu_a_i[25], alu_b_i[25], alu_c_i[25]}],
+                        alu_imm8_i[{alu_a_i[24], alu_b_i[24], alu_c_i[24]}],
+                        alu_imm8_i[{alu_a_i[23], alu_b_i[23], alu_c_i[23]}],
+                        alu_imm8_i[{alu_a_i[22], alu_b_i[22], alu_c_i[22]}],
+                        alu_imm8_i[{alu_a_i[21], alu_b_i[21], alu_c_i[21]}],
+                        alu_imm8_i[{alu_a_i[20], alu_b_i[20], alu_c_i[20]}],
+                        alu_imm8_i[{alu_a_i[19], alu_b_i[19], alu_c_i[19]}],
+                        alu_imm8_i[{alu_a_i[18], alu_b_i[18], alu_c_i[18]}],
+                        alu_imm8_i[{alu_a_i[17], alu_b_i[17], alu_c_i[17]}],
+                        alu_imm8_i[{alu_a_i[16], alu_b_i[16], alu_c_i[16]}],
+                        alu_imm8_i[{alu_a_i[15], alu_b_i[15], alu_c_i[15]}],
+                        alu_imm8_i[{alu_a_i[14], alu_b_i[14], alu_c_i[14]}],
+                        alu_imm8_i[{alu_a_i[13], alu_b_i[13], alu_c_i[13]}],
+                        alu_imm8_i[{alu_a_i[12], alu_b_i[12], alu_c_i[12]}],
+                        alu_imm8_i[{alu_a_i[11], alu_b_i[11], alu_c_i[11]}],
+                        alu_imm8_i[{alu_a_i[10], alu_b_i[10], alu_c_i[10]}],
+                        alu_imm8_i[{alu_a_i[9],  alu_b_i[9],  alu_c_i[9]}],
+                        alu_imm8_i[{alu_a_i[8],  alu_b_i[8],  alu_c_i[8]}],
+                        alu_imm8_i[{alu_a_i[7],  alu_b_i[7],  alu_c_i[7]}],
+                        alu_imm8_i[{alu_a_i[6],  alu_b_i[6],  alu_c_i[6]}],
+                        alu_imm8_i[{alu_a_i[5],  alu_b_i[5],  alu_c_i[5]}],
+                        alu_imm8_i[{alu_a_i[4],  alu_b_i[4],  alu_c_i[4]}],
+                        alu_imm8_i[{alu_a_i[3],  alu_b_i[3],  alu_c_i[3]}],
+                        alu_imm8_i[{alu_a_i[2],  alu_b_i[2],  alu_c_i[2]}],
+                        alu_imm8_i[{alu_a_i[1],  alu_b_i[1],  alu_c_i[1]}],
+                        alu_imm8_i[{alu_a_i[0],  alu_b_i[0],  alu_c_i[0]}]};
        end
        //----------------------------------------------
        // Conditional Move (condition evaluated in exec stage)
@@ -280,6 +308,147 @@ begin
             // Sum all absolute differences and add to accumulator (rs3 = alu_c_i)
             result_r = alu_c_i + {23'b0, sad_abs0_r} + {23'b0, sad_abs1_r} + {23'b0, sad_abs2_r} + {23'b0, sad_abs3_r};
        end
+       //----------------------------------------------
+       // Sum of Absolute Differences (2x 16-bit packed)
+       //----------------------------------------------
+       `ALU_SAD16 :
+       begin
+            sad16_abs0_r = (alu_a_i[15:0] >= alu_b_i[15:0]) ?
+                           {1'b0, alu_a_i[15:0] - alu_b_i[15:0]} :
+                           {1'b0, alu_b_i[15:0] - alu_a_i[15:0]};
+
+            sad16_abs1_r = (alu_a_i[31:16] >= alu_b_i[31:16]) ?
+                           {1'b0, alu_a_i[31:16] - alu_b_i[31:16]} :
+                           {1'b0, alu_b_i[31:16] - alu_a_i[31:16]};
+
+            result_r = alu_c_i + {15'b0, sad16_abs0_r} + {15'b0, sad16_abs1_r};
+       end
+       //----------------------------------------------
+       // Packed 16-bit Add / Subtract
+       //----------------------------------------------
+       `ALU_ADD16 :
+       begin
+            result_r = {alu_a_i[31:16] + alu_b_i[31:16], alu_a_i[15:0] + alu_b_i[15:0]};
+       end
+       `ALU_SUB16 :
+       begin
+            result_r = {alu_a_i[31:16] - alu_b_i[31:16], alu_a_i[15:0] - alu_b_i[15:0]};
+       end
+       //----------------------------------------------
+       // Packed 8-bit Arithmetic
+       //----------------------------------------------
+       `ALU_ADD8 :
+       begin
+            result_r = {byte_sum3_w[7:0], byte_sum2_w[7:0], byte_sum1_w[7:0], byte_sum0_w[7:0]};
+       end
+       `ALU_SUB8 :
+       begin
+            result_r = {byte_diff3_w[7:0], byte_diff2_w[7:0], byte_diff1_w[7:0], byte_diff0_w[7:0]};
+       end
+       `ALU_ADDUS8 :
+       begin
+            // Carry out of a lane saturates it to 255
+            result_r = {byte_sum3_w[8] ? 8'hFF : byte_sum3_w[7:0],
+                        byte_sum2_w[8] ? 8'hFF : byte_sum2_w[7:0],
+                        byte_sum1_w[8] ? 8'hFF : byte_sum1_w[7:0],
+                        byte_sum0_w[8] ? 8'hFF : byte_sum0_w[7:0]};
+       end
+       `ALU_SUBUS8 :
+       begin
+            // Borrow out of a lane saturates it to 0
+            result_r = {byte_diff3_w[8] ? 8'h00 : byte_diff3_w[7:0],
+                        byte_diff2_w[8] ? 8'h00 : byte_diff2_w[7:0],
+                        byte_diff1_w[8] ? 8'h00 : byte_diff1_w[7:0],
+                        byte_diff0_w[8] ? 8'h00 : byte_diff0_w[7:0]};
+       end
+       `ALU_AVGU8 :
+       begin
+            // a + b + 1 is at most 511, so the 9-bit sum does not overflow
+            byte_avg0_r = byte_sum0_w + 9'd1;
+            byte_avg1_r = byte_sum1_w + 9'd1;
+            byte_avg2_r = byte_sum2_w + 9'd1;
+            byte_avg3_r = byte_sum3_w + 9'd1;
+
+            result_r = {byte_avg3_r[8:1], byte_avg2_r[8:1], byte_avg1_r[8:1], byte_avg0_r[8:1]};
+       end
+       `ALU_MINU8 :
+       begin
+            result_r = {byte_diff3_w[8] ? alu_a_i[31:24] : alu_b_i[31:24],
+                        byte_diff2_w[8] ? alu_a_i[23:16] : alu_b_i[23:16],
+                        byte_diff1_w[8] ? alu_a_i[15:8]  : alu_b_i[15:8],
+                        byte_diff0_w[8] ? alu_a_i[7:0]   : alu_b_i[7:0]};
+       end
+       `ALU_MAXU8 :
+       begin
+            result_r = {byte_diff3_w[8] ? alu_b_i[31:24] : alu_a_i[31:24],
+                        byte_diff2_w[8] ? alu_b_i[23:16] : alu_a_i[23:16],
+                        byte_diff1_w[8] ? alu_b_i[15:8]  : alu_a_i[15:8],
+                        byte_diff0_w[8] ? alu_b_i[7:0]   : alu_a_i[7:0]};
+       end
+       //----------------------------------------------
+       // 4-point Hadamard, sum of magnitudes
+       //----------------------------------------------
+       `ALU_SATD4 :
+       begin
+            // First butterfly stage, 17-bit signed
+            satd_s01_r = {alu_a_i[15], alu_a_i[15:0]} + {alu_a_i[31], alu_a_i[31:16]};
+            satd_d01_r = {alu_a_i[15], alu_a_i[15:0]} - {alu_a_i[31], alu_a_i[31:16]};
+            satd_s23_r = {alu_b_i[15], alu_b_i[15:0]} + {alu_b_i[31], alu_b_i[31:16]};
+            satd_d23_r = {alu_b_i[15], alu_b_i[15:0]} - {alu_b_i[31], alu_b_i[31:16]};
+
+            satd_abs_s01_r = satd_s01_r[16] ? -satd_s01_r : satd_s01_r;
+            satd_abs_d01_r = satd_d01_r[16] ? -satd_d01_r : satd_d01_r;
+            satd_abs_s23_r = satd_s23_r[16] ? -satd_s23_r : satd_s23_r;
+            satd_abs_d23_r = satd_d23_r[16] ? -satd_d23_r : satd_d23_r;
+
+            // The second stage is folded into the magnitudes:
+            // |a + b| + |a - b| = 2 * max(|a|, |b|)
+            satd_max_s_r = (satd_abs_s01_r > satd_abs_s23_r) ? satd_abs_s01_r : satd_abs_s23_r;
+            satd_max_d_r = (satd_abs_d01_r > satd_abs_d23_r) ? satd_abs_d01_r : satd_abs_d23_r;
+
+            result_r = alu_c_i + {14'b0, satd_max_s_r, 1'b0} + {14'b0, satd_max_d_r, 1'b0};
+       end
+       //----------------------------------------------
+       // Minimum / Maximum
+       //----------------------------------------------
+       `ALU_MIN :
+       begin
+            result_r      = less_than_signed_w ? alu_a_i : alu_b_i;
+       end
+       `ALU_MAX :
+       begin
+            result_r      = less_than_signed_w ? alu_b_i : alu_a_i;
+       end
+       `ALU_MINU :
+       begin
+            result_r      = less_than_w ? alu_a_i : alu_b_i;
+       end
+       `ALU_MAXU :
+       begin
+            result_r      = less_than_w ? alu_b_i : alu_a_i;
+       end
+       //----------------------------------------------
+       // Saturating Clip
+       //----------------------------------------------
+       `ALU_CLIP :
+       begin
+            if ($signed(alu_a_i) > $signed(clip_max_w))
+                result_r  = clip_max_w;
+            else if ($signed(alu_a_i) < $signed(clip_min_w))
+                result_r  = clip_min_w;
+            else
+                result_r  = alu_a_i;
+       end
+       `ALU_CLIPU :
+       begin
+            // Negative inputs clip to 0, the rest compare unsigned
+            if (alu_a_i[31])
+                result_r  = 32'b0;
+            else if (alu_a_i > clip_max_w)
+                result_r  = clip_max_w;
+            else
+                result_r  = alu_a_i;
+       end
        default  :
        begin
             result_r      = alu_a_i;
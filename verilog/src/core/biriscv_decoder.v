@@ -97,9 +97,33 @@ wire invalid_w =    valid_i &&
                     ((opcode_i & `INST_CSEL_MASK) == `INST_CSEL)              ||
                     ((opcode_i & `INST_BREV_MASK) == `INST_BREV)              ||
                     ((opcode_i & `INST_MADD_MASK) == `INST_MADD)              ||
+                    ((opcode_i & `INST_DMADD16_MASK) == `INST_DMADD16)        ||
+                    ((opcode_i & `INST_DMADD16U_MASK) == `INST_DMADD16U)      ||
+                    ((opcode_i & `INST_DOT4_MASK) == `INST_DOT4)              ||
+                    ((opcode_i & `INST_DOT4U_MASK) == `INST_DOT4U)            ||
+                    ((opcode_i & `INST_DOT4US_MASK) == `INST_DOT4US)          ||
                     ((opcode_i & `INST_TERNLOG_MASK) == `INST_TERNLOG)        ||
+                    ((opcode_i & `INST_TERNLOG3_MASK) == `INST_TERNLOG3)      ||
                     ((opcode_i & `INST_CMOV_MASK) == `INST_CMOV)              ||
                     ((opcode_i & `INST_SAD_MASK) == `INST_SAD)                ||
+                    ((opcode_i & `INST_SADS_MASK) == `INST_SADS)              ||
+                    ((opcode_i & `INST_SAD16_MASK) == `INST_SAD16)            ||
+                    ((opcode_i & `INST_ADD16_MASK) == `INST_ADD16)            ||
+                    ((opcode_i & `INST_SUB16_MASK) == `INST_SUB16)            ||
+                    ((opcode_i & `INST_ADD_B_MASK) == `INST_ADD_B)            ||
+                    ((opcode_i & `INST_SUB_B_MASK) == `INST_SUB_B)            ||
+                    ((opcode_i & `INST_ADDUS_B_MASK) == `INST_ADDUS_B)        ||
+                    ((opcode_i & `INST_SUBUS_B_MASK) == `INST_SUBUS_B)        ||
+                    ((opcode_i & `INST_AVGU_B_MASK) == `INST_AVGU_B)          ||
+                    ((opcode_i & `INST_MINU_B_MASK) == `INST_MINU_B)          ||
+                    ((opcode_i & `INST_MAXU_B_MASK) == `INST_MAXU_B)          ||
+                    ((opcode_i & `INST_SATD4_MASK) == `INST_SATD4)            ||
+                    ((opcode_i & `INST_MIN_MASK) == `INST_MIN)                ||
+                    ((opcode_i & `INST_MAX_MASK) == `INST_MAX)                ||
+                    ((opcode_i & `INST_MINU_MASK) == `INST_MINU)              ||
+                    ((opcode_i & `INST_MAXU_MASK) == `INST_MAXU)              ||
+                    ((opcode_i & `INST_CLIP_MASK) == `INST_CLIP)              ||
+                    ((opcode_i & `INST_CLIPU_MASK) == `INST_CLIPU)            ||
                     (enable_muldiv_i && (opcode_i & `INST_MUL_MASK) == `INST_MUL)       ||
                     (enable_muldiv_i && (opcode_i & `INST_MULH_MASK) == `INST_MULH)     ||
                     (enable_muldiv_i && (opcode_i & `INST_MULHSU_MASK) == `INST_MULHSU) ||
@@ -157,9 +181,33 @@ assign rd_valid_o = ((opcode_i & `INST_JALR_MASK) == `INST_JALR)     ||
                     ((opcode_i & `INST_CSEL_MASK) == `INST_CSEL)     ||
                     ((opcode_i & `INST_BREV_MASK) == `INST_BREV)     ||
                     ((opcode_i & `INST_MADD_MASK) == `INST_MADD)     ||
+                    ((opcode_i & `INST_DMADD16_MASK) == `INST_DMADD16) ||
+                    ((opcode_i & `INST_DMADD16U_MASK) == `INST_DMADD16U) ||
+                    ((opcode_i & `INST_DOT4_MASK) == `INST_DOT4)     ||
+                    ((opcode_i & `INST_DOT4U_MASK) == `INST_DOT4U)   ||
+                    ((opcode_i & `INST_DOT4US_MASK) == `INST_DOT4US) ||
                     ((opcode_i & `INST_TERNLOG_MASK) == `INST_TERNLOG) ||
+                    ((opcode_i & `INST_TERNLOG3_MASK) == `INST_TERNLOG3) ||
                     ((opcode_i & `INST_CMOV_MASK) == `INST_CMOV)     ||
-                    ((opcode_i & `INST_SAD_MASK) == `INST_SAD);
+                    ((opcode_i & `INST_SAD_MASK) == `INST_SAD)       ||
+                    ((opcode_i & `INST_SADS_MASK) == `INST_SADS)     ||
+                    ((opcode_i & `INST_SAD16_MASK) == `INST_SAD16)   ||
+                    ((opcode_i & `INST_ADD16_MASK) == `INST_ADD16)   ||
+                    ((opcode_i & `INST_SUB16_MASK) == `INST_SUB16)   ||
+                    ((opcode_i & `INST_ADD_B_MASK) == `INST_ADD_B)   ||
+                    ((opcode_i & `INST_SUB_B_MASK) == `INST_SUB_B)   ||
+                    ((opcode_i & `INST_ADDUS_B_MASK) == `INST_ADDUS_B) ||
+                    ((opcode_i & `INST_SUBUS_B_MASK) == `INST_SUBUS_B) ||
+                    ((opcode_i & `INST_AVGU_B_MASK) == `INST_AVGU_B) ||
+                    ((opcode_i & `INST_MINU_B_MASK) == `INST_MINU_B) ||
+                    ((opcode_i & `INST_MAXU_B_MASK) == `INST_MAXU_B) ||
+                    ((opcode_i & `INST_SATD4_MASK) == `INST_SATD4)   ||
+                    ((opcode_i & `INST_MIN_MASK) == `INST_MIN)       ||
+                    ((opcode_i & `INST_MAX_MASK) == `INST_MAX)       ||
+                    ((opcode_i & `INST_MINU_MASK) == `INST_MINU)     ||
+                    ((opcode_i & `INST_MAXU_MASK) == `INST_MAXU)     ||
+                    ((opcode_i & `INST_CLIP_MASK) == `INST_CLIP)     ||
+                    ((opcode_i & `INST_CLIPU_MASK) == `INST_CLIPU);
 
 assign exec_o =     ((opcode_i & `INST_ANDI_MASK) == `INST_ANDI)  ||
                     ((opcode_i & `INST_ADDI_MASK) == `INST_ADDI)  ||
@@ -185,8 +233,27 @@ assign exec_o =     ((opcode_i & `INST_ANDI_MASK) == `INST_ANDI)  ||
                     ((opcode_i & `INST_CSEL_MASK) == `INST_CSEL)  ||
                     ((opcode_i & `INST_BREV_MASK) == `INST_BREV)  ||
                     ((opcode_i & `INST_TERNLOG_MASK) == `INST_TERNLOG) ||
+                    ((opcode_i & `INST_TERNLOG3_MASK) == `INST_TERNLOG3) ||
                     ((opcode_i & `INST_CMOV_MASK) == `INST_CMOV)  ||
-                    ((opcode_i & `INST_SAD_MASK) == `INST_SAD);
+                    ((opcode_i & `INST_SAD_MASK) == `INST_SAD)    ||
+                    ((opcode_i & `INST_SADS_MASK) == `INST_SADS)  ||
+                    ((opcode_i & `INST_SAD16_MASK) == `INST_SAD16) ||
+                    ((opcode_i & `INST_ADD16_MASK) == `INST_ADD16) ||
+                    ((opcode_i & `INST_SUB16_MASK) == `INST_SUB16) ||
+                    ((opcode_i & `INST_ADD_B_MASK) == `INST_ADD_B) ||
+                    ((opcode_i & `INST_SUB_B_MASK) == `INST_SUB_B) ||
+                    ((opcode_i & `INST_ADDUS_B_MASK) == `INST_ADDUS_B) ||
+                    ((opcode_i & `INST_SUBUS_B_MASK) == `INST_SUBUS_B) ||
+                    ((opcode_i & `INST_AVGU_B_MASK) == `INST_AVGU_B) ||
+                    ((opcode_i & `INST_MINU_B_MASK) == `INST_MINU_B) ||
+                    ((opcode_i & `INST_MAXU_B_MASK) == `INST_MAXU_B) ||
+                    ((opcode_i & `INST_SATD4_MASK) == `INST_SATD4) ||
+                    ((opcode_i & `INST_MIN_MASK) == `INST_MIN)    ||
+                    ((opcode_i & `INST_MAX_MASK) == `INST_MAX)    ||
+                    ((opcode_i & `INST_MINU_MASK) == `INST_MINU)  ||
+                    ((opcode_i & `INST_MAXU_MASK) == `INST_MAXU)  ||
+                    ((opcode_i & `INST_CLIP_MASK) == `INST_CLIP)  ||
+                    ((opcode_i & `INST_CLIPU_MASK) == `INST_CLIPU);
 
 assign lsu_o =      ((opcode_i & `INST_LB_MASK) == `INST_LB)   ||
                     ((opcode_i & `INST_LH_MASK) == `INST_LH)   ||
@@ -212,7 +279,12 @@ assign mul_o =      enable_muldiv_i &&
                     ((opcode_i & `INST_MULH_MASK) == `INST_MULH)   ||
                     ((opcode_i & `INST_MULHSU_MASK) == `INST_MULHSU) ||
                     ((opcode_i & `INST_MULHU_MASK) == `INST_MULHU) ||
-                    ((opcode_i & `INST_MADD_MASK) == `INST_MADD));
+                    ((opcode_i & `INST_MADD_MASK) == `INST_MADD)   ||
+                    ((opcode_i & `INST_DMADD16_MASK) == `INST_DMADD16) ||
+                    ((opcode_i & `INST_DMADD16U_MASK) == `INST_DMADD16U) ||
+                    ((opcode_i & `INST_DOT4_MASK) == `INST_DOT4)   ||
+                    ((opcode_i & `INST_DOT4U_MASK) == `INST_DOT4U) ||
+                    ((opcode_i & `INST_DOT4US_MASK) == `INST_DOT4US));
 
 assign div_o =      enable_muldiv_i &&
                     (((opcode_i & `INST_DIV_MASK) == `INST_DIV) ||
@@ -25,23 +25,40 @@
 //--------------------------------------------------------------------
 // ALU Operations
 //--------------------------------------------------------------------
-`define ALU_NONE                                5'b00000
-`define ALU_SHIFTL                              5'b00001
-`define ALU_SHIFTR                              5'b00010
-`define ALU_SHIFTR_ARITH                        5'b00011
-`define ALU_ADD                                 5'b00100
-`define ALU_SUB                                 5'b00110
-`define ALU_AND                                 5'b00111
-`define ALU_OR                                  5'b01000
-`define ALU_XOR                                 5'b01001
-`define ALU_LESS_THAN                           5'b01010
-`define ALU_LESS_THAN_SIGNED                    5'b01011
-`define ALU_CSEL                                5'b01100
-`define ALU_BREV                                5'b01101
-`define ALU_MADD                                5'b01110
-`define ALU_TERNLOG                             5'b01111
-`define ALU_CMOV                                5'b10000
-`define ALU_SAD                                 5'b10001
+`define ALU_NONE                                6'b000000
+`define ALU_SHIFTL                              6'b000001
+`define ALU_SHIFTR                              6'b000010
+`define ALU_SHIFTR_ARITH                        6'b000011
+`define ALU_ADD                                 6'b000100
+`define ALU_SUB                                 6'b000110
+`define ALU_AND                                 6'b000111
+`define ALU_OR                                  6'b001000
+`define ALU_XOR                                 6'b001001
+`define ALU_LESS_THAN                           6'b001010
+`define ALU_LESS_THAN_SIGNED                    6'b001011
+`define ALU_CSEL                                6'b001100
+`define ALU_BREV                                6'b001101
+`define ALU_MADD                                6'b001110
+`define ALU_TERNLOG                             6'b001111
+`define ALU_CMOV                                6'b010000
+`define ALU_SAD                                 6'b010001
+`define ALU_MIN                                 6'b010010
+`define ALU_MAX                                 6'b010011
+`define ALU_MINU                                6'b010100
+`define ALU_MAXU                                6'b010101
+`define ALU_CLIP                                6'b010110
+`define ALU_CLIPU                               6'b010111
+`define ALU_SAD16                               6'b011000
+`define ALU_ADD16                               6'b011001
+`define ALU_SUB16                               6'b011010
+`define ALU_SATD4                               6'b011011
+`define ALU_ADD8                                6'b011100
+`define ALU_SUB8                                6'b011101
+`define ALU_ADDUS8                              6'b011110
+`define ALU_SUBUS8                              6'b011111
+`define ALU_AVGU8                               6'b100000
+`define ALU_MINU8                               6'b100001
+`define ALU_MAXU8                               6'b100010
 
 //--------------------------------------------------------------------
 // Instructions Masks
@@ -306,13 +323,51 @@
 `define INST_MADD 32'h0200007b
 `define INST_MADD_MASK 32'h0600707f
 
+// dmadd16 / dmadd16u (Dual 16-bit Multiply-Add)
+// Format: dmadd16 rd, rs1, rs2, rs3    dmadd16u rd, rs1, rs2, rs3
+// Operation: rd = rs1[15:0] * rs2[15:0] + rs1[31:16] * rs2[31:16] + rs3 (lower 32 bits)
+//            dmadd16 takes the halfwords as signed, dmadd16u as unsigned
+// Encoding (R4-type): rs3[31:27], funct2[26:25]=01, rs2[24:20], rs1[19:15], funct3[14:12]=001/010 (dmadd16/dmadd16u), rd[11:7], opcode[6:0]=0x7B (custom-3)
+// Two taps of a 16-bit FIR per instruction; runs in the multiplier with the same latency as madd
+`define INST_DMADD16 32'h0200107b
+`define INST_DMADD16_MASK 32'h0600707f
+
+`define INST_DMADD16U 32'h0200207b
+`define INST_DMADD16U_MASK 32'h0600707f
+
+// dot4 / dot4u / dot4us (4-lane 8-bit Dot Product-Accumulate)
+// Format: dot4 rd, rs1, rs2, rs3    dot4u rd, rs1, rs2, rs3    dot4us rd, rs1, rs2, rs3
+// Operation: rd = rs1[7:0] * rs2[7:0] + rs1[15:8] * rs2[15:8] +
+//                 rs1[23:16] * rs2[23:16] + rs1[31:24] * rs2[31:24] + rs3 (lower 32 bits)
+//            dot4 takes both bytes as signed, dot4u both as unsigned,
+//            dot4us the rs1 bytes as unsigned and the rs2 bytes as signed
+// Encoding (R4-type): rs3[31:27], funct2[26:25], rs2[24:20], rs1[19:15], funct3[14:12], rd[11:7], opcode[6:0]=0x7B (custom-3)
+//            dot4: funct2=01 funct3=011, dot4u/dot4us: funct2=11 funct3=110/111
+// Four int8 MACs of a quantized layer per instruction; runs in the multiplier with the same latency as madd
+`define INST_DOT4 32'h0200307b
+`define INST_DOT4_MASK 32'h0600707f
+
+`define INST_DOT4U 32'h0600607b
+`define INST_DOT4U_MASK 32'h0600707f
+
+`define INST_DOT4US 32'h0600707b
+`define INST_DOT4US_MASK 32'h0600707f
+
 // ternlog (Bitwise Ternary Logic)
-// Format: ternlog rd, rs1, rs2, rs3, imm8
-// Operation: For each bit i: index={rs1[i],rs2[i],rs3[i]}, rd[i]=imm8[index] (3-input LUT, 256 possible functions)
+// Format: ternlog rd, rs1, rs2, imm8
+// Operation: For each bit i: index={rs1[i],rs2[i],0}, rd[i]=imm8[index] (3-input LUT, third input hardwired to 0)
 // Encoding (R4-type with split imm): imm8[7:3][31:27], funct2[26:25]=10, rs2[24:20], rs1[19:15], imm8[2:0][14:12], rd[11:7], opcode[6:0]=0x7B (custom-3)
 `define INST_TERNLOG 32'h0400007b
 `define INST_TERNLOG_MASK 32'h0600007f
 
+// ternlog3 (Bitwise Ternary Logic, 3 sources)
+// Format: ternlog3 rd, rs1, rs2, imm8
+// Operation: For each bit i: index={rs1[i],rs2[i],rd[i]}, rd[i]=imm8[index] (3-input LUT, 256 possible functions)
+// Encoding (R4-type with split imm): imm8[7:3][31:27], funct2[26:25]=10, rs2[24:20], rs1[19:15], imm8[2:0][14:12], rd[11:7], opcode[6:0]=0x5B (custom-2)
+// rd is both the third source and the destination; it is read through the rc register file port
+`define INST_TERNLOG3 32'h0400005b
+`define INST_TERNLOG3_MASK 32'h0600007f
+
 // cmov (Conditional Move)
 // Format: cmov rd, rs1, rs2, rs3
 // Operation: rd = (rs3 != 0) ? rs1 : rs2  (move rs1 to rd if rs3 is non-zero, else move rs2)
@@ -329,6 +384,104 @@
 `define INST_SAD 32'h0600207b
 `define INST_SAD_MASK 32'h0600707f
 
+// sads (Sum of Absolute Differences, signed bytes)
+// Format: sads rd, rs1, rs2, rs3
+// Operation: same as sad, with each byte lane taken as a signed (two's complement) value
+// Encoding (R4-type): rs3[31:27], funct2[26:25]=11, rs2[24:20], rs1[19:15], funct3[14:12]=011, rd[11:7], opcode[6:0]=0x7B (custom-3)
+// |a - b| of two signed bytes equals |(a ^ 0x80) - (b ^ 0x80)| of the unsigned bytes, so this runs on ALU_SAD with the lane sign bits flipped
+`define INST_SADS 32'h0600307b
+`define INST_SADS_MASK 32'h0600707f
+
+// sad16 (Sum of Absolute Differences, 16-bit lanes)
+// Format: sad16 rd, rs1, rs2, rs3
+// Operation: rd = rs3 + |rs1[15:0] - rs2[15:0]| + |rs1[31:16] - rs2[31:16]|  (unsigned halfwords)
+// Encoding (R4-type): rs3[31:27], funct2[26:25]=11, rs2[24:20], rs1[19:15], funct3[14:12]=100, rd[11:7], opcode[6:0]=0x7B (custom-3)
+// For 10/12-bit pixels stored as uint16_t
+`define INST_SAD16 32'h0600407b
+`define INST_SAD16_MASK 32'h0600707f
+
+// add16 / sub16 (Packed 16-bit Add and Subtract)
+// Format: add16 rd, rs1, rs2    sub16 rd, rs1, rs2
+// Operation: add16: rd[15:0] = rs1[15:0] + rs2[15:0], rd[31:16] = rs1[31:16] + rs2[31:16]
+//            sub16: rd[15:0] = rs1[15:0] - rs2[15:0], rd[31:16] = rs1[31:16] - rs2[31:16]  (lanes wrap, no carry between them)
+// Encoding (R-type): funct7[31:25]=0000000/0100000 (add16/sub16), rs2[24:20], rs1[19:15], funct3[14:12]=011, rd[11:7], opcode[6:0]=0x7B (custom-3)
+// Together they are one butterfly stage of a Hadamard transform on two columns at a time
+`define INST_ADD16 32'h0000307b
+`define INST_ADD16_MASK 32'hfe00707f
+
+`define INST_SUB16 32'h4000307b
+`define INST_SUB16_MASK 32'hfe00707f
+
+// add.b / sub.b / addus.b / subus.b / avgu.b / minu.b / maxu.b (Packed 8-bit Arithmetic)
+// Format: add.b rd, rs1, rs2   (same for the others)
+// Operation, per byte lane i (rs1[8i+7:8i] = a, rs2[8i+7:8i] = b), lanes independent:
+//            add.b:   rd = a + b (wraps)              sub.b:   rd = a - b (wraps)
+//            addus.b: rd = min(a + b, 255)            subus.b: rd = max(a - b, 0)
+//            avgu.b:  rd = (a + b + 1) >> 1           minu.b / maxu.b: rd = unsigned min / max of a, b
+// Encoding (R-type): funct7[31:25]=0000100/0100100 (add.b/sub.b), 0001000/0101000 (addus.b/subus.b),
+//                    0001100 (avgu.b), 0010000/0010100 (minu.b/maxu.b), rs2[24:20], rs1[19:15],
+//                    funct3[14:12]=011, rd[11:7], opcode[6:0]=0x7B (custom-3)
+// funct7[5] selects subtract as it does for add16/sub16
+`define INST_ADD_B 32'h0800307b
+`define INST_ADD_B_MASK 32'hfe00707f
+
+`define INST_SUB_B 32'h4800307b
+`define INST_SUB_B_MASK 32'hfe00707f
+
+`define INST_ADDUS_B 32'h1000307b
+`define INST_ADDUS_B_MASK 32'hfe00707f
+
+`define INST_SUBUS_B 32'h5000307b
+`define INST_SUBUS_B_MASK 32'hfe00707f
+
+`define INST_AVGU_B 32'h1800307b
+`define INST_AVGU_B_MASK 32'hfe00707f
+
+`define INST_MINU_B 32'h2000307b
+`define INST_MINU_B_MASK 32'hfe00707f
+
+`define INST_MAXU_B 32'h2800307b
+`define INST_MAXU_B_MASK 32'hfe00707f
+
+// satd4 (Sum of Absolute Hadamard-Transformed Differences, 4 points)
+// Format: satd4 rd, rs1, rs2, rs3
+// Operation: x0..x3 = signed halfwords rs1[15:0], rs1[31:16], rs2[15:0], rs2[31:16]
+//            rd = rs3 + |x0+x1+x2+x3| + |x0-x1+x2-x3| + |x0+x1-x2-x3| + |x0-x1-x2+x3|
+// Encoding (R4-type): rs3[31:27], funct2[26:25]=11, rs2[24:20], rs1[19:15], funct3[14:12]=101, rd[11:7], opcode[6:0]=0x7B (custom-3)
+// One row of a 4x4 SATD after the vertical butterflies (add16/sub16); the sum is not halved
+`define INST_SATD4 32'h0600507b
+`define INST_SATD4_MASK 32'h0600707f
+
+// min / max / minu / maxu (Minimum and Maximum)
+// Format: min rd, rs1, rs2
+// Operation: min:  rd = (rs1 <s rs2) ? rs1 : rs2    max:  rd = (rs1 <s rs2) ? rs2 : rs1
+//            minu: rd = (rs1 <u rs2) ? rs1 : rs2    maxu: rd = (rs1 <u rs2) ? rs2 : rs1
+// Encoding (R-type): funct7[31:25]=0000101, rs2[24:20], rs1[19:15], funct3[14:12]=100/101/110/111 (min/minu/max/maxu), rd[11:7], opcode[6:0]=0x7B (custom-3)
+// Same funct7/funct3 as Zbb, but in the custom-3 opcode; funct2[26:25]=01 with funct3!=000 does not clash with MADD
+`define INST_MIN 32'h0a00407b
+`define INST_MIN_MASK 32'hfe00707f
+
+`define INST_MINU 32'h0a00507b
+`define INST_MINU_MASK 32'hfe00707f
+
+`define INST_MAX 32'h0a00607b
+`define INST_MAX_MASK 32'hfe00707f
+
+`define INST_MAXU 32'h0a00707b
+`define INST_MAXU_MASK 32'hfe00707f
+
+// clip / clipu (Saturating Clip to a power-of-two range)
+// Format: clip rd, rs1, imm5    clipu rd, rs1, imm5
+// Operation: clip:  rd = rs1 clamped (signed) to [-2^imm5, 2^imm5 - 1]
+//            clipu: rd = rs1 clamped (signed) to [0, 2^imm5 - 1]
+// Encoding (R-type, imm5 in rs2 field): funct7[31:25]=0000100, imm5[24:20], rs1[19:15], funct3[14:12]=001/010 (clip/clipu), rd[11:7], opcode[6:0]=0x7B (custom-3)
+// clipu rd, rs1, 8 is the [0, 255] pixel clamp
+`define INST_CLIP 32'h0800107b
+`define INST_CLIP_MASK 32'hfe00707f
+
+`define INST_CLIPU 32'h0800207b
+`define INST_CLIPU_MASK 32'hfe00707f
+
 //--------------------------------------------------------------------
 // Privilege levels
 //--------------------------------------------------------------------
@@ -86,7 +86,7 @@ end
 //-------------------------------------------------------------
 // Execute - ALU operations
 //-------------------------------------------------------------
-reg [4:0]  alu_func_r;
+reg [5:0]  alu_func_r;
 reg [31:0] alu_input_a_r;
 reg [31:0] alu_input_b_r;
 reg [31:0] alu_input_c_r;
@@ -241,7 +241,15 @@ begin
         alu_func_r       = `ALU_TERNLOG;
         alu_input_a_r    = opcode_ra_operand_i;
         alu_input_b_r    = opcode_rb_operand_i;
-        // Note: TERNLOG uses only 2 sources + 8-bit immediate (no rs3)
+        // Note: TERNLOG uses only 2 sources + 8-bit immediate (third LUT input is 0)
+        alu_input_imm8_r = imm8_r;
+    end
+    else if ((opcode_opcode_i & `INST_TERNLOG3_MASK) == `INST_TERNLOG3) // ternlog3
+    begin
+        alu_func_r       = `ALU_TERNLOG;
+        alu_input_a_r    = opcode_ra_operand_i;
+        alu_input_b_r    = opcode_rb_operand_i;
+        alu_input_c_r    = opcode_rc_operand_i;  // old rd value
         alu_input_imm8_r = imm8_r;
     end
     else if ((opcode_opcode_i & `INST_CMOV_MASK) == `INST_CMOV) // cmov
@@ -258,6 +266,119 @@ begin
         alu_input_b_r  = opcode_rb_operand_i;  // rs2 (packed bytes)
         alu_input_c_r  = opcode_rc_operand_i;  // rs3 (accumulator)
     end
+    else if ((opcode_opcode_i & `INST_SADS_MASK) == `INST_SADS) // sads
+    begin
+        // Signed lanes: flipping each sign bit maps -128..127 onto 0..255
+        // without changing the lane differences
+        alu_func_r     = `ALU_SAD;
+        alu_input_a_r  = opcode_ra_operand_i ^ 32'h80808080;
+        alu_input_b_r  = opcode_rb_operand_i ^ 32'h80808080;
+        alu_input_c_r  = opcode_rc_operand_i;
+    end
+    else if ((opcode_opcode_i & `INST_SAD16_MASK) == `INST_SAD16) // sad16
+    begin
+        alu_func_r     = `ALU_SAD16;
+        alu_input_a_r  = opcode_ra_operand_i;  // rs1 (packed halfwords)
+        alu_input_b_r  = opcode_rb_operand_i;  // rs2 (packed halfwords)
+        alu_input_c_r  = opcode_rc_operand_i;  // rs3 (accumulator)
+    end
+    else if ((opcode_opcode_i & `INST_ADD16_MASK) == `INST_ADD16) // add16
+    begin
+        alu_func_r     = `ALU_ADD16;
+        alu_input_a_r  = opcode_ra_operand_i;
+        alu_input_b_r  = opcode_rb_operand_i;
+    end
+    else if ((opcode_opcode_i & `INST_SUB16_MASK) == `INST_SUB16) // sub16
+    begin
+        alu_func_r     = `ALU_SUB16;
+        alu_input_a_r  = opcode_ra_operand_i;
+        alu_input_b_r  = opcode_rb_operand_i;
+    end
+    else if ((opcode_opcode_i & `INST_ADD_B_MASK) == `INST_ADD_B) // add.b
+    begin
+        alu_func_r     = `ALU_ADD8;
+        alu_input_a_r  = opcode_ra_operand_i;
+        alu_input_b_r  = opcode_rb_operand_i;
+    end
+    else if ((opcode_opcode_i & `INST_SUB_B_MASK) == `INST_SUB_B) // sub.b
+    begin
+        alu_func_r     = `ALU_SUB8;
+        alu_input_a_r  = opcode_ra_operand_i;
+        alu_input_b_r  = opcode_rb_operand_i;
+    end
+    else if ((opcode_opcode_i & `INST_ADDUS_B_MASK) == `INST_ADDUS_B) // addus.b
+    begin
+        alu_func_r     = `ALU_ADDUS8;
+        alu_input_a_r  = opcode_ra_operand_i;
+        alu_input_b_r  = opcode_rb_operand_i;
+    end
+    else if ((opcode_opcode_i & `INST_SUBUS_B_MASK) == `INST_SUBUS_B) // subus.b
+    begin
+        alu_func_r     = `ALU_SUBUS8;
+        alu_input_a_r  = opcode_ra_operand_i;
+        alu_input_b_r  = opcode_rb_operand_i;
+    end
+    else if ((opcode_opcode_i & `INST_AVGU_B_MASK) == `INST_AVGU_B) // avgu.b
+    begin
+        alu_func_r     = `ALU_AVGU8;
+        alu_input_a_r  = opcode_ra_operand_i;
+        alu_input_b_r  = opcode_rb_operand_i;
+    end
+    else if ((opcode_opcode_i & `INST_MINU_B_MASK) == `INST_MINU_B) // minu.b
+    begin
+        alu_func_r     = `ALU_MINU8;
+        alu_input_a_r  = opcode_ra_operand_i;
+        alu_input_b_r  = opcode_rb_operand_i;
+    end
+    else if ((opcode_opcode_i & `INST_MAXU_B_MASK) == `INST_MAXU_B) // maxu.b
+    begin
+        alu_func_r     = `ALU_MAXU8;
+        alu_input_a_r  = opcode_ra_operand_i;
+        alu_input_b_r  = opcode_rb_operand_i;
+    end
+    else if ((opcode_opcode_i & `INST_SATD4_MASK) == `INST_SATD4) // satd4
+    begin
+        alu_func_r     = `ALU_SATD4;
+        alu_input_a_r  = opcode_ra_operand_i;  // rs1 (x1:x0)
+        alu_input_b_r  = opcode_rb_operand_i;  // rs2 (x3:x2)
+        alu_input_c_r  = opcode_rc_operand_i;  // rs3 (accumulator)
+    end
+    else if ((opcode_opcode_i & `INST_MIN_MASK) == `INST_MIN) // min
+    begin
+        alu_func_r     = `ALU_MIN;
+        alu_input_a_r  = opcode_ra_operand_i;
+        alu_input_b_r  = opcode_rb_operand_i;
+    end
+    else if ((opcode_opcode_i & `INST_MAX_MASK) == `INST_MAX) // max
+    begin
+        alu_func_r     = `ALU_MAX;
+        alu_input_a_r  = opcode_ra_operand_i;
+        alu_input_b_r  = opcode_rb_operand_i;
+    end
+    else if ((opcode_opcode_i & `INST_MINU_MASK) == `INST_MINU) // minu
+    begin
+        alu_func_r     = `ALU_MINU;
+        alu_input_a_r  = opcode_ra_operand_i;
+        alu_input_b_r  = opcode_rb_operand_i;
+    end
+    else if ((opcode_opcode_i & `INST_MAXU_MASK) == `INST_MAXU) // maxu
+    begin
+        alu_func_r     = `ALU_MAXU;
+        alu_input_a_r  = opcode_ra_operand_i;
+        alu_input_b_r  = opcode_rb_operand_i;
+    end
+    else if ((opcode_opcode_i & `INST_CLIP_MASK) == `INST_CLIP) // clip
+    begin
+        alu_func_r     = `ALU_CLIP;
+        alu_input_a_r  = opcode_ra_operand_i;
+        alu_input_b_r  = {27'b0, shamt_r};  // imm5 sits in the rs2/shamt field
+    end
+    else if ((opcode_opcode_i & `INST_CLIPU_MASK) == `INST_CLIPU) // clipu
+    begin
+        alu_func_r     = `ALU_CLIPU;
+        alu_input_a_r  = opcode_ra_operand_i;
+        alu_input_b_r  = {27'b0, shamt_r};
+    end
     else if (((opcode_opcode_i & `INST_JAL_MASK) == `INST_JAL) || ((opcode_opcode_i & `INST_JALR_MASK) == `INST_JALR)) // jal, jalr
     begin
         alu_func_r     = `ALU_ADD;
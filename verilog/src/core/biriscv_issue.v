@@ -311,11 +311,23 @@ end
 
 wire [4:0] issue_a_ra_idx_w   = opcode_a_r[19:15];
 wire [4:0] issue_a_rb_idx_w   = opcode_a_r[24:20];
-wire [4:0] issue_a_rc_idx_w   = opcode_a_r[31:27];  // R4-type rs3
+wire       issue_a_ternlog3_w = ((opcode_a_r & `INST_TERNLOG3_MASK) == `INST_TERNLOG3);
+wire [4:0] issue_a_rc_idx_w   = issue_a_ternlog3_w ? opcode_a_r[11:7]    // TERNLOG3 reads rd
+                                                    : opcode_a_r[31:27];  // R4-type rs3
 wire [4:0] issue_a_rd_idx_w   = opcode_a_r[11:7];
 wire       issue_a_uses_rc_w  = ((opcode_a_r & `INST_CSEL_MASK) == `INST_CSEL) ||
                                  ((opcode_a_r & `INST_MADD_MASK) == `INST_MADD) ||
-                                 ((opcode_a_r & `INST_CMOV_MASK) == `INST_CMOV);
+                                 ((opcode_a_r & `INST_DMADD16_MASK) == `INST_DMADD16)   ||
+                                 ((opcode_a_r & `INST_DMADD16U_MASK) == `INST_DMADD16U) ||
+                                 ((opcode_a_r & `INST_DOT4_MASK) == `INST_DOT4)       ||
+                                 ((opcode_a_r & `INST_DOT4U_MASK) == `INST_DOT4U)     ||
+                                 ((opcode_a_r & `INST_DOT4US_MASK) == `INST_DOT4US)   ||
+                                 ((opcode_a_r & `INST_CMOV_MASK) == `INST_CMOV) ||
+                                 ((opcode_a_r & `INST_SAD_MASK) == `INST_SAD)   ||
+                                 ((opcode_a_r & `INST_SADS_MASK) == `INST_SADS) ||
+                                 ((opcode_a_r & `INST_SAD16_MASK) == `INST_SAD16) ||
+                                 ((opcode_a_r & `INST_SATD4_MASK) == `INST_SATD4) ||
+                                 issue_a_ternlog3_w;
 wire       issue_a_sb_alloc_w = (slot0_valid_r ? fetch0_instr_rd_valid_i : fetch1_instr_rd_valid_i);
 wire       issue_a_exec_w     = (slot0_valid_r ? fetch0_instr_exec_i     : fetch1_instr_exec_i);
 wire       issue_a_lsu_w      = (slot0_valid_r ? fetch0_instr_lsu_i      : fetch1_instr_lsu_i);
@@ -328,11 +340,23 @@ wire       issue_a_invalid_w  = (slot0_valid_r ? fetch0_instr_invalid_i  : fetch
 
 wire [4:0] issue_b_ra_idx_w   = opcode_b_r[19:15];
 wire [4:0] issue_b_rb_idx_w   = opcode_b_r[24:20];
-wire [4:0] issue_b_rc_idx_w   = opcode_b_r[31:27];  // R4-type rs3
+wire       issue_b_ternlog3_w = ((opcode_b_r & `INST_TERNLOG3_MASK) == `INST_TERNLOG3);
+wire [4:0] issue_b_rc_idx_w   = issue_b_ternlog3_w ? opcode_b_r[11:7]    // TERNLOG3 reads rd
+                                                    : opcode_b_r[31:27];  // R4-type rs3
 wire [4:0] issue_b_rd_idx_w   = opcode_b_r[11:7];
 wire       issue_b_uses_rc_w  = ((opcode_b_r & `INST_CSEL_MASK) == `INST_CSEL) ||
                                  ((opcode_b_r & `INST_MADD_MASK) == `INST_MADD) ||
-                                 ((opcode_b_r & `INST_CMOV_MASK) == `INST_CMOV);
+                                 ((opcode_b_r & `INST_DMADD16_MASK) == `INST_DMADD16)   ||
+                                 ((opcode_b_r & `INST_DMADD16U_MASK) == `INST_DMADD16U) ||
+                                 ((opcode_b_r & `INST_DOT4_MASK) == `INST_DOT4)       ||
+                                 ((opcode_b_r & `INST_DOT4U_MASK) == `INST_DOT4U)     ||
+                                 ((opcode_b_r & `INST_DOT4US_MASK) == `INST_DOT4US)   ||
+                                 ((opcode_b_r & `INST_CMOV_MASK) == `INST_CMOV) ||
+                                 ((opcode_b_r & `INST_SAD_MASK) == `INST_SAD)   ||
+                                 ((opcode_b_r & `INST_SADS_MASK) == `INST_SADS) ||
+                                 ((opcode_b_r & `INST_SAD16_MASK) == `INST_SAD16) ||
+                                 ((opcode_b_r & `INST_SATD4_MASK) == `INST_SATD4) ||
+                                 issue_b_ternlog3_w;
 wire       issue_b_sb_alloc_w = fetch1_instr_rd_valid_i;
 wire       issue_b_exec_w     = fetch1_instr_exec_i;
 wire       issue_b_lsu_w      = fetch1_instr_lsu_i;
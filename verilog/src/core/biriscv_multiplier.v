@@ -64,6 +64,11 @@ reg [32:0]   operand_b_e1_q;
 reg [31:0]   operand_c_e1_q;
 reg          mulhi_sel_e1_q;
 reg          madd_sel_e1_q;
+reg          dmadd_sel_e1_q;
+reg          dmadd_signed_e1_q;
+reg          dot4_sel_e1_q;
+reg          dot4_a_signed_e1_q;
+reg          dot4_b_signed_e1_q;
 
 //-------------------------------------------------------------
 // Multiplier
@@ -77,9 +82,21 @@ wire mult_inst_w    = ((opcode_opcode_i & `INST_MUL_MASK) == `INST_MUL)        |
                       ((opcode_opcode_i & `INST_MULH_MASK) == `INST_MULH)      ||
                       ((opcode_opcode_i & `INST_MULHSU_MASK) == `INST_MULHSU)  ||
                       ((opcode_opcode_i & `INST_MULHU_MASK) == `INST_MULHU)    ||
-                      ((opcode_opcode_i & `INST_MADD_MASK) == `INST_MADD);
+                      ((opcode_opcode_i & `INST_MADD_MASK) == `INST_MADD)      ||
+                      ((opcode_opcode_i & `INST_DMADD16_MASK) == `INST_DMADD16) ||
+                      ((opcode_opcode_i & `INST_DMADD16U_MASK) == `INST_DMADD16U) ||
+                      ((opcode_opcode_i & `INST_DOT4_MASK) == `INST_DOT4)      ||
+                      ((opcode_opcode_i & `INST_DOT4U_MASK) == `INST_DOT4U)    ||
+                      ((opcode_opcode_i & `INST_DOT4US_MASK) == `INST_DOT4US);
 
 wire madd_inst_w    = ((opcode_opcode_i & `INST_MADD_MASK) == `INST_MADD);
+wire dmadd_signed_w = ((opcode_opcode_i & `INST_DMADD16_MASK) == `INST_DMADD16);
+wire dmadd_inst_w   = dmadd_signed_w ||
+                      ((opcode_opcode_i & `INST_DMADD16U_MASK) == `INST_DMADD16U);
+wire dot4_ss_w      = ((opcode_opcode_i & `INST_DOT4_MASK) == `INST_DOT4);
+wire dot4_us_w      = ((opcode_opcode_i & `INST_DOT4US_MASK) == `INST_DOT4US);
+wire dot4_inst_w    = dot4_ss_w || dot4_us_w ||
+                      ((opcode_opcode_i & `INST_DOT4U_MASK) == `INST_DOT4U);
 
 
 always @ *
@@ -88,7 +105,7 @@ begin
         operand_a_r = {opcode_ra_operand_i[31], opcode_ra_operand_i[31:0]};
     else if ((opcode_opcode_i & `INST_MULH_MASK) == `INST_MULH)
         operand_a_r = {opcode_ra_operand_i[31], opcode_ra_operand_i[31:0]};
-    else // MULHU || MUL || MADD (all unsigned multiply)
+    else // MULHU || MUL || MADD (all unsigned multiply), DMADD16/DOT4 (split below)
         operand_a_r = {1'b0, opcode_ra_operand_i[31:0]};
 end
 
@@ -98,7 +115,7 @@ begin
         operand_b_r = {1'b0, opcode_rb_operand_i[31:0]};
     else if ((opcode_opcode_i & `INST_MULH_MASK) == `INST_MULH)
         operand_b_r = {opcode_rb_operand_i[31], opcode_rb_operand_i[31:0]};
-    else // MULHU || MUL || MADD (all unsigned multiply)
+    else // MULHU || MUL || MADD (all unsigned multiply), DMADD16/DOT4 (split below)
         operand_b_r = {1'b0, opcode_rb_operand_i[31:0]};
 end
 
@@ -112,6 +129,11 @@ begin
     operand_c_e1_q <= 32'b0;
     mulhi_sel_e1_q <= 1'b0;
     madd_sel_e1_q  <= 1'b0;
+    dmadd_sel_e1_q <= 1'b0;
+    dmadd_signed_e1_q <= 1'b0;
+    dot4_sel_e1_q  <= 1'b0;
+    dot4_a_signed_e1_q <= 1'b0;
+    dot4_b_signed_e1_q <= 1'b0;
 end
 else if (hold_i)
     ;
@@ -120,8 +142,13 @@ begin
     operand_a_e1_q <= operand_a_r;
     operand_b_e1_q <= operand_b_r;
     operand_c_e1_q <= opcode_rc_operand_i;
-    mulhi_sel_e1_q <= ~((opcode_opcode_i & `INST_MUL_MASK) == `INST_MUL) && ~madd_inst_w;
+    mulhi_sel_e1_q <= ~((opcode_opcode_i & `INST_MUL_MASK) == `INST_MUL) && ~madd_inst_w && ~dmadd_inst_w && ~dot4_inst_w;
     madd_sel_e1_q  <= madd_inst_w;
+    dmadd_sel_e1_q <= dmadd_inst_w;
+    dmadd_signed_e1_q <= dmadd_signed_w;
+    dot4_sel_e1_q  <= dot4_inst_w;
+    dot4_a_signed_e1_q <= dot4_ss_w;
+    dot4_b_signed_e1_q <= dot4_ss_w || dot4_us_w;
 end
 else
 begin
@@ -130,15 +157,54 @@ begin
     operand_c_e1_q <= 32'b0;
     mulhi_sel_e1_q <= 1'b0;
     madd_sel_e1_q  <= 1'b0;
+    dmadd_sel_e1_q <= 1'b0;
+    dmadd_signed_e1_q <= 1'b0;
+    dot4_sel_e1_q  <= 1'b0;
+    dot4_a_signed_e1_q <= 1'b0;
+    dot4_b_signed_e1_q <= 1'b0;
 end
 
 assign mult_result_w = {{ 32 {operand_a_e1_q[32]}}, operand_a_e1_q}*{{ 32 {operand_b_e1_q[32]}}, operand_b_e1_q};
 
+//-------------------------------------------------------------
+// DMADD16: two 16x16 products of the halfword lanes. Each product of
+// halfwords extended to 32 bits is exact in its lower 32 bits (signed
+// or unsigned), which is all that the wrapping sum keeps.
+//-------------------------------------------------------------
+wire [31:0]  dmadd_a_lo_w = {{16{dmadd_signed_e1_q & operand_a_e1_q[15]}}, operand_a_e1_q[15:0]};
+wire [31:0]  dmadd_a_hi_w = {{16{dmadd_signed_e1_q & operand_a_e1_q[31]}}, operand_a_e1_q[31:16]};
+wire [31:0]  dmadd_b_lo_w = {{16{dmadd_signed_e1_q & operand_b_e1_q[15]}}, operand_b_e1_q[15:0]};
+wire [31:0]  dmadd_b_hi_w = {{16{dmadd_signed_e1_q & operand_b_e1_q[31]}}, operand_b_e1_q[31:16]};
+wire [31:0]  dmadd_lo_w   = dmadd_a_lo_w * dmadd_b_lo_w;
+wire [31:0]  dmadd_hi_w   = dmadd_a_hi_w * dmadd_b_hi_w;
+
+//-------------------------------------------------------------
+// DOT4: four 8x8 products of the byte lanes, exact in their
+// lower 32 bits like DMADD16. DOT4U zero-extends both bytes,
+// DOT4US only the rs1 byte.
+//-------------------------------------------------------------
+wire [31:0]  dot4_a0_w = {{24{dot4_a_signed_e1_q & operand_a_e1_q[7]}},  operand_a_e1_q[7:0]};
+wire [31:0]  dot4_a1_w = {{24{dot4_a_signed_e1_q & operand_a_e1_q[15]}}, operand_a_e1_q[15:8]};
+wire [31:0]  dot4_a2_w = {{24{dot4_a_signed_e1_q & operand_a_e1_q[23]}}, operand_a_e1_q[23:16]};
+wire [31:0]  dot4_a3_w = {{24{dot4_a_signed_e1_q & operand_a_e1_q[31]}}, operand_a_e1_q[31:24]};
+wire [31:0]  dot4_b0_w = {{24{dot4_b_signed_e1_q & operand_b_e1_q[7]}},  operand_b_e1_q[7:0]};
+wire [31:0]  dot4_b1_w = {{24{dot4_b_signed_e1_q & operand_b_e1_q[15]}}, operand_b_e1_q[15:8]};
+wire [31:0]  dot4_b2_w = {{24{dot4_b_signed_e1_q & operand_b_e1_q[23]}}, operand_b_e1_q[23:16]};
+wire [31:0]  dot4_b3_w = {{24{dot4_b_signed_e1_q & operand_b_e1_q[31]}}, operand_b_e1_q[31:24]};
+wire [31:0]  dot4_sum_w = dot4_a0_w * dot4_b0_w + dot4_a1_w * dot4_b1_w +
+                          dot4_a2_w * dot4_b2_w + dot4_a3_w * dot4_b3_w;
+
 always @ *
 begin
     if (madd_sel_e1_q)
         // MADD: Add accumulator to lower 32 bits of multiplication result
         result_r = mult_result_w[31:0] + operand_c_e1_q;
+    else if (dmadd_sel_e1_q)
+        // DMADD16/DMADD16U: Sum of the lane products plus accumulator
+        result_r = dmadd_lo_w + dmadd_hi_w + operand_c_e1_q;
+    else if (dot4_sel_e1_q)
+        // DOT4/DOT4U/DOT4US: Sum of the four byte products plus accumulator
+        result_r = dot4_sum_w + operand_c_e1_q;
     else if (mulhi_sel_e1_q)
         // MULH/MULHU/MULHSU: Return upper 32 bits
         result_r = mult_result_w[63:32];
@@ -0,0 +1,279 @@
+module tb_top;
+
+reg clk;
+reg rst;
+
+reg [7:0] mem[131072:0];
+integer i;
+integer f;
+
+// Performance counters
+integer instruction_count;
+integer cycle_count;
+
+initial
+begin
+    $display("Starting SAD16 instruction test");
+
+    // Reset
+    clk = 0;
+    rst = 1;
+    repeat (5) @(posedge clk);
+    rst = 0;
+
+    // Load TCM memory
+    for (i=0;i<131072;i=i+1)
+        mem[i] = 0;
+
+    f = $fopen("tcm.bin", "rb");
+    if (f == 0) begin
+        $display("ERROR: Cannot open tcm.bin");
+        $finish;
+    end
+    i = $fread(mem, f);
+    $fclose(f);
+    $display("Loaded %0d bytes into TCM memory", i);
+    for (i=0;i<131072;i=i+1)
+        u_mem.write(i, mem[i]);
+end
+
+initial
+begin
+    forever
+    begin
+        clk = #5 ~clk;
+    end
+end
+
+// Performance counter: count retired instructions and cycles
+initial
+begin
+    instruction_count = 0;
+    cycle_count = 0;
+
+    @(negedge rst);
+
+    forever begin
+        @(posedge clk);
+        cycle_count = cycle_count + 1;
+
+        // Count pipe0 instruction retirement
+        if (u_dut.u_issue.pipe0_valid_wb_w) begin
+            instruction_count = instruction_count + 1;
+        end
+
+        // Count pipe1 instruction retirement (dual-issue core)
+        if (u_dut.u_issue.pipe1_valid_wb_w) begin
+            instruction_count = instruction_count + 1;
+        end
+    end
+end
+
+// Monitor for test completion (CSR write)
+reg [63:0] mem_word;
+reg [31:0] result1, result2, result3, result4, result5, result6;
+initial
+begin
+    @(negedge rst);
+
+    // Wait for CSR write to complete
+    forever begin
+        @(posedge clk);
+        // Check for CSR write instruction
+        if (u_dut.u_exec0.opcode_valid_i &&
+            (u_dut.u_exec0.opcode_opcode_i[6:0] == 7'b1110011) &&
+            (u_dut.u_exec0.opcode_opcode_i[14:12] == 3'b001)) begin
+            // Wait a few cycles for final stores
+            repeat (10) @(posedge clk);
+
+            // Read 6 results from memory (address 0x80001000 = word index 0x200)
+            mem_word = u_mem.u_ram.ram[16'h200];
+            result1 = mem_word[31:0];
+            result2 = mem_word[63:32];
+
+            mem_word = u_mem.u_ram.ram[16'h201];
+            result3 = mem_word[31:0];
+            result4 = mem_word[63:32];
+
+            mem_word = u_mem.u_ram.ram[16'h202];
+            result5 = mem_word[31:0];
+            result6 = mem_word[63:32];
+
+            $display("");
+            $display("==========================================================");
+            $display("SAD16 Instruction Test Results");
+            $display("==========================================================");
+            $display("");
+            $display("  sad16 rd, rs1, rs2, rs3: rd = rs3 + |rs1[15:0] - rs2[15:0]| + |rs1[31:16] - rs2[31:16]|");
+            $display("");
+
+            $display("Test 1 - sad16 x1, x2:");
+            $display("  Result: 0x%08h | Expected: 0x000013CE | %s",
+                     result1, result1 == 32'h000013CE ? "PASS" : "FAIL");
+            $display("");
+
+            $display("Test 2 - sad16 x2, x1 (swapped):");
+            $display("  Result: 0x%08h | Expected: 0x000013CE | %s",
+                     result2, result2 == 32'h000013CE ? "PASS" : "FAIL");
+            $display("");
+
+            $display("Test 3 - sad16 x1, x2, x3=100:");
+            $display("  Result: 0x%08h | Expected: 0x00001432 | %s",
+                     result3, result3 == 32'h00001432 ? "PASS" : "FAIL");
+            $display("");
+
+            $display("Test 4 - sad16 x4, x5 (full-scale lanes):");
+            $display("  Result: 0x%08h | Expected: 0x0001FFFE | %s",
+                     result4, result4 == 32'h0001FFFE ? "PASS" : "FAIL");
+            $display("");
+
+            $display("Test 5 - sad16 x4, x4:");
+            $display("  Result: 0x%08h | Expected: 0x00000000 | %s",
+                     result5, result5 == 32'h00000000 ? "PASS" : "FAIL");
+            $display("");
+
+            $display("Test 6 - sad16 x5, x4, x3=100:");
+            $display("  Result: 0x%08h | Expected: 0x00020062 | %s",
+                     result6, result6 == 32'h00020062 ? "PASS" : "FAIL");
+            $display("");
+
+            $display("==========================================================");
+
+            // Count passes
+            if (result1 == 32'h000013CE &&
+                result2 == 32'h000013CE &&
+                result3 == 32'h00001432 &&
+                result4 == 32'h0001FFFE &&
+                result5 == 32'h00000000 &&
+                result6 == 32'h00020062) begin
+                $display("");
+                $display("==========================================");
+                $display("ALL SAD16 TESTS PASSED!");
+                $display("==========================================");
+                $display("");
+            end else begin
+                $display("");
+                $display("==========================================");
+                $display("SOME TESTS FAILED - CHECK IMPLEMENTATION");
+                $display("==========================================");
+                $display("");
+            end
+
+            // Display performance metrics
+            $display("==========================================");
+            $display("Performance Metrics:");
+            $display("==========================================");
+            $display("Total Cycles: %0d", cycle_count);
+            $display("Total Instructions Retired: %0d", instruction_count);
+            $display("CPI (Cycles Per Instruction): %f", $itor(cycle_count) / $itor(instruction_count));
+            $display("IPC (Instructions Per Cycle): %f", $itor(instruction_count) / $itor(cycle_count));
+            $display("==========================================\n");
+
+            $finish;
+        end
+    end
+end
+
+// Timeout after 100000 cycles
+initial
+begin
+    repeat (100000) @(posedge clk);
+    $display("TIMEOUT: Simulation reached 100000 cycles");
+    $display("Performance: Cycles=%0d Instructions=%0d", cycle_count, instruction_count);
+    $finish;
+end
+
+wire          mem_i_rd_w;
+wire          mem_i_flush_w;
+wire          mem_i_invalidate_w;
+wire [ 31:0]  mem_i_pc_w;
+wire [ 31:0]  mem_d_addr_w;
+wire [ 31:0]  mem_d_data_wr_w;
+wire          mem_d_rd_w;
+wire [  3:0]  mem_d_wr_w;
+wire          mem_d_cacheable_w;
+wire [ 10:0]  mem_d_req_tag_w;
+wire          mem_d_invalidate_w;
+wire          mem_d_writeback_w;
+wire          mem_d_flush_w;
+wire          mem_i_accept_w;
+wire          mem_i_valid_w;
+wire          mem_i_error_w;
+wire [ 63:0]  mem_i_inst_w;
+wire [ 31:0]  mem_d_data_rd_w;
+wire          mem_d_accept_w;
+wire          mem_d_ack_w;
+wire          mem_d_error_w;
+wire [ 10:0]  mem_d_resp_tag_w;
+
+riscv_core
+u_dut
+//-----------------------------------------------------------------
+// Ports
+//-----------------------------------------------------------------
+(
+    // Inputs
+     .clk_i(clk)
+    ,.rst_i(rst)
+    ,.mem_d_data_rd_i(mem_d_data_rd_w)
+    ,.mem_d_accept_i(mem_d_accept_w)
+    ,.mem_d_ack_i(mem_d_ack_w)
+    ,.mem_d_error_i(mem_d_error_w)
+    ,.mem_d_resp_tag_i(mem_d_resp_tag_w)
+    ,.mem_i_accept_i(mem_i_accept_w)
+    ,.mem_i_valid_i(mem_i_valid_w)
+    ,.mem_i_error_i(mem_i_error_w)
+    ,.mem_i_inst_i(mem_i_inst_w)
+    ,.intr_i(1'b0)
+    ,.reset_vector_i(32'h80000000)
+    ,.cpu_id_i('b0)
+
+    // Outputs
+    ,.mem_d_addr_o(mem_d_addr_w)
+    ,.mem_d_data_wr_o(mem_d_data_wr_w)
+    ,.mem_d_rd_o(mem_d_rd_w)
+    ,.mem_d_wr_o(mem_d_wr_w)
+    ,.mem_d_cacheable_o(mem_d_cacheable_w)
+    ,.mem_d_req_tag_o(mem_d_req_tag_w)
+    ,.mem_d_invalidate_o(mem_d_invalidate_w)
+    ,.mem_d_writeback_o(mem_d_writeback_w)
+    ,.mem_d_flush_o(mem_d_flush_w)
+    ,.mem_i_rd_o(mem_i_rd_w)
+    ,.mem_i_flush_o(mem_i_flush_w)
+    ,.mem_i_invalidate_o(mem_i_invalidate_w)
+    ,.mem_i_pc_o(mem_i_pc_w)
+);
+
+tcm_mem
+u_mem
+(
+    // Inputs
+     .clk_i(clk)
+    ,.rst_i(rst)
+    ,.mem_i_rd_i(mem_i_rd_w)
+    ,.mem_i_flush_i(mem_i_flush_w)
+    ,.mem_i_invalidate_i(mem_i_invalidate_w)
+    ,.mem_i_pc_i(mem_i_pc_w)
+    ,.mem_d_addr_i(mem_d_addr_w)
+    ,.mem_d_data_wr_i(mem_d_data_wr_w)
+    ,.mem_d_rd_i(mem_d_rd_w)
+    ,.mem_d_wr_i(mem_d_wr_w)
+    ,.mem_d_cacheable_i(mem_d_cacheable_w)
+    ,.mem_d_req_tag_i(mem_d_req_tag_w)
+    ,.mem_d_invalidate_i(mem_d_invalidate_w)
+    ,.mem_d_writeback_i(mem_d_writeback_w)
+    ,.mem_d_flush_i(mem_d_flush_w)
+
+    // Outputs
+    ,.mem_i_accept_o(mem_i_accept_w)
+    ,.mem_i_valid_o(mem_i_valid_w)
+    ,.mem_i_error_o(mem_i_error_w)
+    ,.mem_i_inst_o(mem_i_inst_w)
+    ,.mem_d_data_rd_o(mem_d_data_rd_w)
+    ,.mem_d_accept_o(mem_d_accept_w)
+    ,.mem_d_ack_o(mem_d_ack_w)
+    ,.mem_d_error_o(mem_d_error_w)
+    ,.mem_d_resp_tag_o(mem_d_resp_tag_w)
+);
+
+endmodule